@@ -0,0 +1,37 @@
+#ifndef ANTONIUS_ANALYSIS_H
+#define ANTONIUS_ANALYSIS_H
+
+#include <string>
+#include <iostream>
+#include "types.hpp"
+#include "search.hpp"
+
+// Non-interactive batch analysis of FEN/EPD files, written as JSON lines
+// Antonius analyse --input positions.epd --threads 32 --depth 12 --hash 256
+namespace Analysis
+{
+
+    struct Options
+    {
+        std::string input = "-";
+        std::string output = "-";
+        unsigned threads = 1;
+        size_t hashBytes = 16 << 20;
+        SearchLimits limits;
+        SearchOptions searchOptions;
+    };
+
+    struct Stats
+    {
+        U64 positions = 0;
+        U64 nodes = 0;
+        double seconds = 0;
+    };
+
+    Options parseArgs(const VecStr&);
+    Stats run(const Options&, std::istream&, std::ostream&);
+    int main(const VecStr&);
+
+}
+
+#endif
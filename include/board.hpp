@@ -31,6 +31,7 @@ class Board {
         I32 openingScore;
         I32 endgameScore;
         I32 materialScore;
+        U64 materialKey;
 
         // Side to move
         Color stm;
@@ -43,8 +44,8 @@ class Board {
         bool isCheckingMove(Move) const;
         BB getCheckBlockers(Color, Color) const;
 
-                                    int calculateMobilityScore(const int, const int) const;
-        template<PieceType>         int calculateMobilityScore(const int, const int) const;
+                                    int calculateMobilityScore(const Eval::Attacks&, const int, const int) const;
+                                    int calculateKingDanger(Color, const Eval::Attacks&) const;
                                     int calculatePieceScore() const;
         template<PieceType, Color>  int calculatePieceScore() const;
 
@@ -56,6 +57,8 @@ class Board {
         void loadFENEnPassant(const std::string&);
         void loadFENCastle(const std::string&);
         U64 calculateKey() const;
+        U64 calculatePolyglotKey() const;
+        U64 calculateMaterialKey() const;
 
         // make.cpp
         void make(Move);
@@ -66,7 +69,8 @@ class Board {
         template<bool> void makeCastle(Square, Square, Color);
 
         // eval.cpp
-        template<bool> int eval() const;
+        template<bool> int eval(int=-MATESCORE, int=MATESCORE) const;
+        int lazyEval() const;
         
         // Inline functions
         template<bool> void addPiece(Square, Color, PieceType);
@@ -106,7 +110,9 @@ class Board {
         inline Square getKingSq(Color c) const { return kingSq[c]; }
         inline Square getEnPassant() const { return state.at(ply).enPassantSq; }
         inline U8 getHmClock() const { return state.at(ply).hmClock; }
+        inline U32 getFullMoveCounter() const { return fullMoveCounter; }
         inline U64 getKey() const { return state.at(ply).zkey; }
+        inline U64 getMaterialKey() const { return materialKey; }
         inline bool isCheck() const { return !getCheckingPieces().isEmpty(); }
         inline bool isDoubleCheck() const { return getCheckingPieces().moreThanOneSet(); }
         inline int getPieceCount(Color c) const {
@@ -126,6 +132,7 @@ inline void Board::addPiece(const Square sq, const Color c, const PieceType pt)
     squares[sq] = Types::makePiece(c, pt);
 
     // Update evaluation helpers
+    materialKey ^= Zobrist::material[c][pt-1][pieceCount[c][pt]];
     pieceCount[c][pt]++;
     materialScore += Eval::PieceValues[pt-1][c];
     openingScore += Eval::psqv(c, pt, OPENING, sq);
@@ -144,6 +151,7 @@ inline void Board::removePiece(const Square sq, const Color c, const PieceType p
 
     // Update evaluation helpers
     pieceCount[c][pt]--;
+    materialKey ^= Zobrist::material[c][pt-1][pieceCount[c][pt]];
     materialScore -= Eval::PieceValues[pt-1][c];
     openingScore -= Eval::psqv(c, pt, OPENING, sq);
     endgameScore -= Eval::psqv(c, pt, ENDGAME, sq);
@@ -0,0 +1,56 @@
+#ifndef ANTONIUS_BOOKBUILDER_H
+#define ANTONIUS_BOOKBUILDER_H
+
+#include <string>
+#include "types.hpp"
+
+// Builds Polyglot opening books from PGN collections, with bounded memory
+// Antonius book build --input games.pgn --output book.bin --threads 4
+namespace BookBuilder
+{
+
+    struct Options
+    {
+        std::string input;
+        std::string output = "book.bin";
+        unsigned threads = 1;
+        size_t memory = 256 << 20;
+        int maxPly = 30;
+        U32 minGames = 1;
+
+        // Runs open at once while merging, beyond which runs are merged
+        // in several passes to bound the number of open files
+        unsigned maxOpenRuns = 64;
+    };
+
+    struct Stats
+    {
+        U64 games = 0;
+        U64 positions = 0;
+        U64 runs = 0;
+        U64 passes = 0;
+        U64 entries = 0;
+    };
+
+    // Win/draw/loss counts of a move, from the point of view of its side
+    struct Record
+    {
+        U64 key;
+        U16 move;
+        U32 wins;
+        U32 draws;
+        U32 losses;
+
+        inline bool operator<(const Record& rhs) const
+        {
+            return key < rhs.key || (key == rhs.key && move < rhs.move);
+        }
+    };
+
+    Options parseArgs(const VecStr&);
+    Stats build(const Options&);
+    int main(const VecStr&);
+
+}
+
+#endif
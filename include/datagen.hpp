@@ -0,0 +1,63 @@
+#ifndef ANTONIUS_DATAGEN_H
+#define ANTONIUS_DATAGEN_H
+
+#include <string>
+#include "types.hpp"
+#include "search.hpp"
+
+class Board;
+
+// Training data from self-play, as fixed size records of quiet positions
+// with their search scores and game results, so a file can be seeked by
+// record index and shuffled in place of its games
+// Antonius datagen --output data.bin --positions 1000000 --threads 8
+// Antonius datagen shuffle --input data.bin --output shuffled.bin
+namespace DataGen
+{
+
+    // A position packed into 32 bytes, its pieces given by an occupancy
+    // bitboard then one 4 bit Piece per occupied square, in square order
+    struct Record
+    {
+        U64 occupancy;
+        U8 pieces[16];
+        I16 score;       // Search score for white
+        U16 ply;
+        I8 result;       // Game result for white, 1, 0 or -1
+        U8 flags;        // Side to move in bit 0, castling rights above it
+        U8 hmClock;
+        U8 enPassant;    // Square, or 64 if none
+    };
+    static_assert(sizeof(Record) == 32, "Records are 32 bytes");
+
+    struct Options
+    {
+        std::string input;
+        std::string output = "data.bin";
+        unsigned threads = 1;
+        U64 positions = 1000000;
+        SearchLimits limits;
+        size_t hashBytes = 2 << 20;
+        int randomPlies = 10;
+        U64 seed = 0;
+        int maxScore = 3000;
+    };
+
+    struct Stats
+    {
+        U64 games = 0;
+        U64 positions = 0;
+        U64 skipped = 0;
+    };
+
+    Record pack(const Board&, int, int, int);
+    std::string unpack(const Record&);
+
+    Options parseArgs(const VecStr&);
+    Stats generate(const Options&);
+    U64 shuffle(const Options&);
+    int main(const VecStr&);
+
+}
+
+#endif
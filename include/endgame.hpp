@@ -0,0 +1,50 @@
+#ifndef ANTONIUS_ENDGAME_H
+#define ANTONIUS_ENDGAME_H
+
+#include <string>
+#include "types.hpp"
+
+class Board;
+
+// Endgames the search would otherwise spend many nodes to resolve,
+// scored directly from a KPK bitbase and evaluators dispatched on the
+// material key of the position
+namespace Endgame
+{
+
+    // Score of an endgame for its strong side
+    using Evaluator = int (*)(const Board&, Color);
+
+    // Scale factor of an endgame the eval still scores
+    using Scaler = int (*)(const Board&);
+
+    // Scores of known wins, above any material but below mate scores
+    const int KNOWN_WIN = 10000;
+
+    // Scale factors, in 64ths of the eval
+    const int SCALE_NORMAL = 64;
+    const int SCALE_OPPOSITE_BISHOPS = 32;
+
+    // Generate the KPK bitbase and register the evaluators
+    void init();
+
+    // Whether the side with the pawn wins, given its king and pawn, the
+    // other king and the side to move
+    bool probeKPK(Color, Square, Square, Square, Color);
+
+    // The evaluator registered for a material key, and its strong side
+    bool find(U64, Evaluator&, Color&);
+
+    // The scaler for a position's material, if any
+    Scaler findScaler(const Board&);
+
+    // Score a recognized endgame for the side to move
+    bool probe(const Board&, int&);
+    bool isKnownDraw(const Board&);
+
+    // Scale factor of drawish endgames the eval still scores
+    int scale(const Board&);
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef ANTONIUS_EPD_H
+#define ANTONIUS_EPD_H
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+#include "move.hpp"
+#include "search.hpp"
+
+// Extended Position Description (EPD) test suites
+// https://www.chessprogramming.org/Extended_Position_Description
+namespace EPD
+{
+
+    // A test position, with its best and avoid moves in SAN
+    struct Position
+    {
+        std::string fen;
+        std::string id;
+        VecStr bestMoves;
+        VecStr avoidMoves;
+    };
+
+    // The outcome of searching a test position
+    struct Result
+    {
+        std::string id;
+        std::string move;
+        bool solved = false;
+        int time = 0;           // Until the final best move was found
+        U64 solutionNodes = 0;  // Likewise
+        U64 nodes = 0;
+    };
+
+    Position parse(const std::string&);
+    std::vector<Position> load(const std::string&);
+
+    std::vector<Result> run(const std::vector<Position>&, const SearchLimits&,
+                            const SearchOptions&, unsigned, size_t, std::ostream&);
+
+}
+
+#endif
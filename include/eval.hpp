@@ -1,6 +1,7 @@
 #ifndef ANTONIUS_EVAL_H
 #define ANTONIUS_EVAL_H
 
+#include <vector>
 #include "types.hpp"
 #include "bitboard.hpp"
 
@@ -28,6 +29,7 @@ namespace Eval
     extern const int MINOR_OUTPOST_BONUS;
     extern const int STRONG_KING_SHIELD_BONUS;
     extern const int WEAK_KING_SHIELD_BONUS;
+    extern const int KING_ATTACK_SCALE;
 
     extern const int KNIGHT_TROPISM[8];
     extern const int BISHOP_TROPISM[8];
@@ -36,6 +38,14 @@ namespace Eval
 
     extern const Square ColorSq[2][64];
 
+    extern const int KingAttackWeight[7];
+    extern const int SafeCheckUnits[7];
+    extern const int KingDanger[100];
+
+    // King safety is phased in over the first full moves of the game, so until
+    // then the eval depends on the move counter as well as the position
+    const U32 KING_SAFETY_MOVES = 16;
+
     inline int psqv(Color c, PieceType pt, int phase, Square sq)
     {
         // Get the piece square value
@@ -44,6 +54,73 @@ namespace Eval
         return (2 * c * score) - score;
     }
 
+    // Squares attacked by each side, filled in once per eval as the pieces
+    // are visited and shared by the terms that need them
+    struct Attacks
+    {
+        BB byType[2][7] = {};   // Indexed by PieceType, from PAWN to KING
+        BB all[2] = {};
+        BB twice[2] = {};       // Attacked by more than one piece
+        int moves[2][7] = {};   // Attacked squares free of own pieces
+
+        // The squares around each king, to be set before any attacks are
+        // added, and the pieces attacking the other side's zone
+        BB kingZone[2] = {};
+        int kingAttackers[2] = {};
+        int kingAttackUnits[2] = {};
+
+        inline void add(Color c, PieceType pt, BB attacks, BB targets = BB(0))
+        {
+            twice[c] |= all[c] & attacks;
+            all[c] |= attacks;
+            byType[c][pt] |= attacks;
+            moves[c][pt] += (attacks & targets).count();
+
+            BB zone = attacks & kingZone[~c];
+            if (zone && KingAttackWeight[pt])
+            {
+                kingAttackers[c]++;
+                kingAttackUnits[c] += KingAttackWeight[pt] * zone.count();
+            }
+        }
+    };
+
+    // A direct-mapped cache of static evals, keyed on the Zobrist key
+    // Each search thread keeps its own, so it needs no locking
+    class Cache
+    {
+    public:
+
+        static const U32 SIZE = 1 << 15;
+
+        Cache() : entries(SIZE) { }
+
+        inline bool probe(U64 key, int& eval) const
+        {
+            const Entry& entry = entries[key & (SIZE - 1)];
+            if (entry.key != key)
+                return false;
+
+            eval = entry.eval;
+            return true;
+        }
+
+        inline void save(U64 key, int eval)
+        {
+            entries[key & (SIZE - 1)] = { key, eval };
+        }
+
+    private:
+
+        struct Entry
+        {
+            U64 key;
+            I32 eval;
+        };
+        std::vector<Entry> entries;
+
+    };
+
     template<Color c>
     inline BB kingShield(Square sq)
     {
@@ -0,0 +1,210 @@
+#ifndef ANTONIUS_EVALPARAMS_H
+#define ANTONIUS_EVALPARAMS_H
+
+// Evaluation parameters, included by eval.cpp only
+// Generated by Antonius tune, see tuner.hpp
+
+#include "types.hpp"
+
+namespace Eval
+{
+
+    const int MobilityScaling[2][6] = {
+        {   0,   6,   2,   0,   0,   0 },
+        {   2,   3,   1,   1,   1,   1 }
+    };
+
+    const int PassedPawnBonus[2]    = {   30,  200 };
+    const int DoublePawnPenalty[2]  = {  -30, -100 };
+    const int TriplePawnPenalty[2]  = {  -45, -100 };
+    const int IsoPawnPenalty[2]     = {  -30,  -40 };
+    const int OpenFileBonus[2]      = {   20,   10 };
+    const int HalfOpenFileBonus[2]  = {   10,    0 };
+    const int BishopPairBonus[2]    = {   20,   60 };
+
+    const int TEMPO_BONUS               = 25;
+    const int KNIGHT_PENALTY_PER_PAWN   = -2;
+    const int ROOK_BONUS_PER_PAWN       = 2;
+    const int CONNECTED_ROOK_BONUS      = 15;
+    const int ROOK_ON_SEVENTH_BONUS     = 20;
+    const int BACK_RANK_MINOR_PENALTY   = -6;
+    const int MINOR_OUTPOST_BONUS       = 10;
+    const int STRONG_KING_SHIELD_BONUS  = 10;
+    const int WEAK_KING_SHIELD_BONUS    = 5;
+    const int KING_ATTACK_SCALE         = 100;
+
+    const int PieceValues[6][2] = {
+        {   -100,   100 },
+        {   -320,   320 },
+        {   -330,   330 },
+        {   -500,   500 },
+        {   -900,   900 },
+        { -20000, 20000 }
+    };
+
+    const int KNIGHT_TROPISM[8] = {
+           0,   5,   4,   2,   0,   0,  -1,  -3
+    };
+
+    const int BISHOP_TROPISM[8] = {
+           0,   5,   4,   3,   2,   1,   0,   0
+    };
+
+    const int ROOK_TROPISM[8] = {
+           0,   6,   5,   3,   2,   1,   0,   0
+    };
+
+    const int QUEEN_TROPISM[8] = {
+           0,  12,  10,   6,   4,   2,   0,  -2
+    };
+
+    const int PieceSqValues[6][2][64] =
+    {
+        { // Pawn piece square values
+            {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                  50,   50,   50,   50,   50,   50,   50,   50,
+                  10,   10,   20,   30,   30,   20,   10,   10,
+                   5,    5,   10,   25,   25,   10,    5,    5,
+                   0,    0,    0,   20,   20,    0,    0,    0,
+                   5,   -5,  -10,    0,    0,  -10,   -5,    5,
+                   5,   10,   10,  -20,  -20,   10,   10,    5,
+                   0,    0,    0,    0,    0,    0,    0,    0
+            }, // Opening
+
+            {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                 115,  125,  125,  125,  125,  125,  125,  125,
+                  85,   95,   95,  105,  105,   95,   95,   85,
+                  75,   85,   90,  100,  100,   90,   85,   65,
+                  65,   80,   80,   95,   95,   80,   80,   65,
+                  55,   75,   75,   75,   75,   75,   75,   55,
+                  50,   70,   70,   70,   70,   70,   70,   50,
+                   0,    0,    0,    0,    0,    0,    0,    0
+            }  // End game
+        },
+
+        { // Knight piece square values
+            {
+                 -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+                 -40,  -20,    0,    0,    0,    0,  -20,  -40,
+                 -30,    0,   10,   15,   15,   10,    0,  -30,
+                 -30,    5,   15,   20,   20,   15,    5,  -30,
+                 -30,    0,   15,   20,   20,   15,    0,  -30,
+                 -30,    5,   10,   15,   15,   10,    5,  -30,
+                 -40,  -20,    0,    5,    5,    0,  -20,  -40,
+                 -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50
+            }, // Opening
+
+            {
+                 -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50,
+                 -40,  -20,    0,    0,    0,    0,  -20,  -40,
+                 -30,    0,   10,   15,   15,   10,    0,  -30,
+                 -30,    5,   15,   20,   20,   15,    5,  -30,
+                 -30,    0,   15,   20,   20,   15,    0,  -30,
+                 -30,    5,   10,   15,   15,   10,    5,  -30,
+                 -40,  -20,    0,    5,    5,    0,  -20,  -40,
+                 -50,  -40,  -30,  -30,  -30,  -30,  -40,  -50
+            }  // End game
+        },
+
+        { // Bishop piece square values
+            {
+                 -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+                 -10,    0,    0,    0,    0,    0,    0,  -10,
+                 -10,    0,    5,   10,   10,    5,    0,  -10,
+                 -10,    5,    5,   10,   10,    5,    5,  -10,
+                 -10,    0,   10,   10,   10,   10,    0,  -10,
+                 -10,   10,   10,   10,   10,   10,   10,  -10,
+                 -10,   10,    0,    0,    0,    0,   10,  -10,
+                 -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20
+            }, // Opening
+
+            {
+                 -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20,
+                 -10,    0,    0,    0,    0,    0,    0,  -10,
+                 -10,    0,    5,   10,   10,    5,    0,  -10,
+                 -10,    5,    5,   10,   10,    5,    5,  -10,
+                 -10,    0,   10,   10,   10,   10,    0,  -10,
+                 -10,   10,   10,   10,   10,   10,   10,  -10,
+                 -10,    5,    0,    0,    0,    0,    5,  -10,
+                 -20,  -10,  -10,  -10,  -10,  -10,  -10,  -20
+            }  // End game
+        },
+
+        { // Rook piece square values
+            {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                   5,   10,   10,   10,   10,   10,   10,    5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                   0,    0,    0,    5,    5,    0,    0,    0
+            }, // Opening
+
+            {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                   5,   10,   10,   10,   10,   10,   10,    5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                  -5,    0,    0,    0,    0,    0,    0,   -5,
+                   0,    0,    0,    5,    5,    0,    0,    0
+            }  // End game
+        },
+
+        { // Queen piece square values
+            {
+                 -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+                 -10,    0,    0,    0,    0,    0,    0,  -10,
+                 -10,    0,    5,    5,    5,    5,    0,  -10,
+                  -5,    0,    5,    5,    5,    5,    0,   -5,
+                   0,    0,    5,    5,    5,    5,    0,   -5,
+                 -10,    5,    5,    5,    5,    5,    0,  -10,
+                 -10,    0,    5,    0,    0,    0,    0,  -10,
+                 -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20
+            }, // Opening
+
+            {
+                 -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20,
+                 -10,    0,    0,    0,    0,    0,    0,  -10,
+                 -10,    0,    5,    5,    5,    5,    0,  -10,
+                  -5,    0,    5,    5,    5,    5,    0,   -5,
+                   0,    0,    5,    5,    5,    5,    0,   -5,
+                 -10,    5,    5,    5,    5,    5,    0,  -10,
+                 -10,    0,    5,    0,    0,    0,    0,  -10,
+                 -20,  -10,  -10,   -5,   -5,  -10,  -10,  -20
+            }  // End game
+        },
+
+        { // King piece square values
+            {
+                  30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+                 -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+                 -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+                 -30,  -40,  -40,  -50,  -50,  -40,  -40,  -30,
+                 -20,  -30,  -30,  -40,  -40,  -30,  -30,  -20,
+                 -10,  -20,  -20,  -20,  -20,  -20,  -20,  -10,
+                  20,   20,    0,    0,    0,    0,   20,   20,
+                  20,   30,   10,    0,    0,   10,   30,   20
+            }, // Opening
+
+            {
+                 -50,  -40,  -30,  -20,  -20,  -30,  -40,  -50,
+                 -30,  -20,  -10,    0,    0,  -10,  -20,  -30,
+                 -30,  -10,   20,   30,   30,   20,  -10,  -30,
+                 -30,  -10,   30,   40,   40,   30,  -10,  -30,
+                 -30,  -10,   30,   40,   40,   30,  -10,  -30,
+                 -30,  -10,   20,   30,   30,   20,  -10,  -30,
+                 -30,  -30,    0,    0,    0,    0,  -30,  -30,
+                 -50,  -30,  -30,  -30,  -30,  -30,  -30,  -50
+            }  // End game
+        }
+    };
+
+}
+
+#endif
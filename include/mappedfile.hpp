@@ -0,0 +1,30 @@
+#ifndef ANTONIUS_MAPPEDFILE_H
+#define ANTONIUS_MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+
+// A read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+
+    explicit MappedFile(const std::string&);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool isOpen() const { return _data != nullptr; }
+    inline const char* data() const { return _data; }
+    inline size_t size() const { return _size; }
+    inline std::string_view text() const { return std::string_view(_data, _size); }
+
+private:
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef ANTONIUS_MATCH_H
+#define ANTONIUS_MATCH_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <memory>
+#include <functional>
+#include "types.hpp"
+#include "move.hpp"
+#include "search.hpp"
+
+class Board;
+
+// Self-play matches between two engine configurations, stopped early by
+// a sequential probability ratio test (SPRT)
+// Antonius match --engine1 FutilityMargin=120 --engine2 cmd=./Antonius-old --threads 8
+namespace Match
+{
+
+    // An engine, either searched in-process with its own options, or an
+    // external UCI engine run over pipes when a command is given
+    struct EngineConfig
+    {
+        std::string command;
+        std::vector<std::pair<std::string, std::string>> options;
+    };
+
+    struct Options
+    {
+        EngineConfig engines[2];
+        std::string openings;
+        unsigned threads = 1;
+        U64 games = 1000;
+        SearchLimits limits;
+        size_t hashBytes = 16 << 20;
+        int randomPlies = 8;
+
+        // Tables that adjudicate positions they hold
+        std::string tablebasePath;
+
+        // Adjudication
+        int maxPlies = 400;
+        int winScore = 1000;
+        int winPlies = 8;
+        int drawScore = 10;
+        int drawPlies = 16;
+        int drawMinPly = 80;
+
+        // SPRT bounds and error rates
+        double elo0 = 0;
+        double elo1 = 5;
+        double alpha = 0.05;
+        double beta = 0.05;
+    };
+
+    // Sequential probability ratio test on game results, using the
+    // generalized SPRT approximation of the log-likelihood ratio
+    struct SPRT
+    {
+        double elo0, elo1, alpha, beta;
+
+        double llr(U64 wins, U64 draws, U64 losses) const;
+        double lowerBound() const;
+        double upperBound() const;
+        int status(U64 wins, U64 draws, U64 losses) const;
+    };
+
+    double elo(U64 wins, U64 draws, U64 losses);
+
+    class Player
+    {
+    public:
+
+        Player(const EngineConfig&, const SearchLimits&, size_t);
+        ~Player();
+
+        Player(const Player&) = delete;
+        Player& operator=(const Player&) = delete;
+
+        void newGame();
+        Move think(Board&, int&);
+
+        // Why the engine could not be started or configured, empty if it
+        // is ready to play
+        inline const std::string& getError() const { return error; }
+
+    private:
+
+        // In-process engines keep one search, and its tables, for every move
+        SearchLimits limits;
+        TT::Table table;
+        Search search;
+        std::string error;
+
+        // External engines
+        int pid = -1;
+        FILE* in = nullptr;
+        FILE* out = nullptr;
+
+        void send(const std::string&);
+        std::string readUntil(const std::string&, VecStr* = nullptr);
+        void start(const EngineConfig&);
+
+    };
+
+    // Called before each move of a game with the position, the move, and
+    // its score for the side to move
+    using MoveCallback = std::function<void(const Board&, Move, int)>;
+
+    Options parseArgs(const VecStr&);
+    std::string opening(const std::vector<std::string>&, U64, int);
+    int playGame(Player&, Player&, const std::string&, const Options&, const MoveCallback& = nullptr);
+    int main(const VecStr&);
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef ANTONIUS_MATERIAL_H
+#define ANTONIUS_MATERIAL_H
+
+#include <string>
+#include "types.hpp"
+#include "endgame.hpp"
+
+class Board;
+
+// What the eval needs to know about the material alone, computed once
+// per combination of piece counts and looked up by the material key
+namespace Material
+{
+
+    struct Entry
+    {
+        U64 key;
+        int phase;
+        double imbalance;       // From white's side, already tapered
+        Endgame::Evaluator evaluator;
+        Endgame::Scaler scaler;
+        Color strong;
+
+        // Score a recognized endgame for the side to move
+        int evaluate(const Board&) const;
+
+        inline int scale(const Board& board) const
+        {
+            return scaler ? scaler(board) : Endgame::SCALE_NORMAL;
+        }
+    };
+
+    // Entries of each thread, so the table needs no locking
+    const U32 TABLE_SIZE = 1 << 12;
+
+    const Entry& probe(const Board&);
+
+    // The material key of a white strong side given as a string such as
+    // "KBNK", the strong side's pieces then the weak side's
+    U64 key(const std::string&, Color = WHITE);
+
+}
+
+#endif
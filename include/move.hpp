@@ -56,7 +56,9 @@ inline PieceType Move::promPiece() const
 
 inline bool Move::isNullMove() const
 {
-    return type() == NULLMOVE;
+    // NULLMOVE does not fit in the two move type bits, so compare the
+    // whole value against the one set by the default constructor
+    return value == U16(NULLMOVE << 12);
 }
 
 inline bool Move::operator==(const Move& rhs) const
@@ -17,13 +17,18 @@ namespace MoveGen
 
         Generator(Board * board)
         : b(board)
-        { }
+        {
+            moves.reserve(MAX_MOVES);
+        }
 
         void run();
         void runq();
 
         std::vector<Move> moves;
 
+        // Enough for nearly all positions, to avoid reallocating while generating
+        const static size_t MAX_MOVES = 128;
+
     private:
         
         Board * b;
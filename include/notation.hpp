@@ -0,0 +1,23 @@
+#ifndef ANTONIUS_NOTATION_H
+#define ANTONIUS_NOTATION_H
+
+#include <string>
+#include <string_view>
+#include "types.hpp"
+#include "move.hpp"
+
+class Board;
+
+// Move notation, in standard algebraic (SAN) and UCI long algebraic form
+// https://www.chessprogramming.org/Algebraic_Chess_Notation
+namespace Notation
+{
+
+    std::string toSAN(Board&, Move);
+    std::string toUCI(Move);
+    Move fromSAN(Board&, std::string_view);
+    Move fromUCI(Board&, std::string_view);
+
+}
+
+#endif
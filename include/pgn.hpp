@@ -0,0 +1,98 @@
+#ifndef ANTONIUS_PGN_H
+#define ANTONIUS_PGN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <thread>
+#include "types.hpp"
+#include "move.hpp"
+#include "board.hpp"
+#include "notation.hpp"
+#include "mappedfile.hpp"
+
+// Portable Game Notation (PGN) databases, streamed from memory-mapped files
+// https://www.chessprogramming.org/Portable_Game_Notation
+namespace PGN
+{
+
+    // A game, whose tags and movetext point into the parsed text
+    struct Game
+    {
+        std::vector<std::pair<std::string_view, std::string_view>> tags;
+        std::string_view movetext;
+        std::string_view result;
+
+        std::string_view tag(std::string_view) const;
+    };
+
+    // Reads games one at a time, without copying the text
+    class Reader
+    {
+    public:
+
+        explicit Reader(std::string_view text) : _text(text) { }
+        bool next(Game&);
+
+    private:
+
+        std::string_view _text;
+        size_t _pos = 0;
+
+    };
+
+    bool nextSAN(std::string_view&, std::string_view&);
+    std::vector<std::string_view> split(std::string_view, unsigned);
+    int main(const VecStr&);
+
+    // Replay a game's moves from its starting position, calling
+    // onMove(board, move) before each move is made
+    // Returns false if a move cannot be resolved
+    template<typename F>
+    bool replay(const Game& game, F&& onMove)
+    {
+        auto fen = game.tag("FEN");
+        Board board(fen.empty() ? G::STARTFEN : std::string(fen));
+
+        std::string_view movetext = game.movetext,
+                         san;
+        while (nextSAN(movetext, san))
+        {
+            Move move = Notation::fromSAN(board, san);
+            if (move.isNullMove())
+                return false;
+
+            onMove(board, move);
+            board.make(move);
+        }
+
+        return true;
+    }
+
+    // Read the games of a text in parallel, split at game boundaries,
+    // calling onGame(thread, game) from each thread
+    template<typename F>
+    void parallelForEach(std::string_view text, unsigned nThreads, F&& onGame)
+    {
+        auto parts = split(text, std::max(1u, nThreads));
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < parts.size(); i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                Reader reader(parts[i]);
+                Game game;
+                while (reader.next(game))
+                    onGame(i, game);
+            });
+        }
+
+        for (auto& thread : workers)
+            thread.join();
+    }
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef ANTONIUS_POLYGLOT_H
+#define ANTONIUS_POLYGLOT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <iostream>
+#include "types.hpp"
+#include "move.hpp"
+
+class Board;
+class MappedFile;
+
+// Polyglot opening books
+// http://hgm.nubati.net/book_format.html
+namespace Polyglot
+{
+
+    // Offsets of the castling, en passant and side to move keys
+    const int CASTLE_KEYS = 768;
+    const int ENPASSANT_KEYS = 772;
+    const int TURN_KEY = 780;
+    const int NKEYS = 781;
+
+    extern const U64 random[NKEYS];
+
+    // A book entry, stored big-endian in 16 bytes
+    struct Entry
+    {
+        U64 key;
+        U16 move;
+        U16 weight;
+        U32 learn;
+    };
+
+    const size_t ENTRY_SIZE = 16;
+
+    U16 encodeMove(Move);
+    Move decodeMove(Board&, U16);
+    void writeEntry(std::ostream&, const Entry&);
+
+    // A read-only book, memory-mapped and binary searched by key
+    class Book
+    {
+    public:
+
+        Book();
+        ~Book();
+
+        bool open(const std::string&);
+        void close();
+        inline bool isOpen() const { return _nEntries > 0; }
+        inline size_t size() const { return _nEntries; }
+
+        std::vector<Entry> probe(U64) const;
+        Move pick(Board&);
+
+    private:
+
+        std::unique_ptr<MappedFile> _file;
+        const unsigned char* _data = nullptr;
+        size_t _nEntries = 0;
+        std::mt19937 _rng;
+
+        Entry entry(size_t) const;
+
+    };
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define ANTONIUS_SEARCH_H
 
 #include <cstring>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <iterator>
@@ -11,6 +12,7 @@
 #include "types.hpp"
 #include "eval.hpp"
 #include "move.hpp"
+#include "tt.hpp"
 
 class Board;
 
@@ -19,50 +21,240 @@ struct Killer {
     Move move2;
 };
 
+// Tunable search parameters, settable via UCI options
+struct SearchOptions {
+    int razorMargin = 300;
+    int futilityMargin = 150;
+    int reverseFutilityMargin = 100;
+    int lazyEvalMargin = 300;
+    int lazyMobilityMargin = 100;
+    int multiPV = 1;
+
+    // Ranges advertised to the GUI, values are clamped to them
+    constexpr static int MAX_MARGIN = 2000;
+    constexpr static int MAX_LAZY_MARGIN = 32000;
+    constexpr static int MAX_MULTIPV = 256;
+
+    // The range of an option by its UCI name, or false if it is unknown
+    static bool range(const std::string& name, int& min, int& max)
+    {
+        min = 0;
+        if (name == "RazorMargin" || name == "FutilityMargin" || name == "ReverseFutilityMargin")
+            max = MAX_MARGIN;
+        else if (name == "LazyEvalMargin" || name == "LazyMobilityMargin")
+            max = MAX_LAZY_MARGIN;
+        else if (name == "MultiPV")
+        {
+            min = 1;
+            max = MAX_MULTIPV;
+        }
+        else
+            return false;
+
+        return true;
+    }
+
+    // Set an option by its UCI name, returning false if it is unknown
+    bool set(const std::string& name, int value)
+    {
+        if (name == "RazorMargin")
+            razorMargin = std::clamp(value, 0, MAX_MARGIN);
+        else if (name == "FutilityMargin")
+            futilityMargin = std::clamp(value, 0, MAX_MARGIN);
+        else if (name == "ReverseFutilityMargin")
+            reverseFutilityMargin = std::clamp(value, 0, MAX_MARGIN);
+        else if (name == "LazyEvalMargin")
+            lazyEvalMargin = std::clamp(value, 0, MAX_LAZY_MARGIN);
+        else if (name == "LazyMobilityMargin")
+            lazyMobilityMargin = std::clamp(value, 0, MAX_LAZY_MARGIN);
+        else if (name == "MultiPV")
+            multiPV = std::clamp(value, 1, MAX_MULTIPV);
+        else
+            return false;
+
+        return true;
+    }
+};
+
+// Limits for a single search, a value of 0 is unlimited
+struct SearchLimits {
+    int depth = 0;
+    U64 nodes = 0;
+    int mate = 0;
+    int movetime = 0;
+};
+
+// A legal move at the root, with the results of searching it
+// Root moves are ordered by score, then by their previous iteration's
+// score, then by the size of their subtree
+struct RootMove {
+
+    RootMove(Move mv)
+    : move(mv), score(-MATESCORE), prevScore(-MATESCORE), nodes(0)
+    { }
+
+    bool operator<(const RootMove& rhs) const
+    {
+        if (score != rhs.score)
+            return score > rhs.score;
+        if (prevScore != rhs.prevScore)
+            return prevScore > rhs.prevScore;
+        return nodes > rhs.nodes;
+    }
+
+    Move move;
+    int score;
+    int prevScore;
+    U64 nodes;
+};
+
+// Continuation history, indexed by side to move, the piece and destination
+// of an earlier move, then the piece and destination of the current move
+using ContHistory = I16[2][6][64][6][64];
+
 class Search
 {
     public:
 
         Search() = default;
-        Search(Board * board)
-        : bestMove(Move()), _board(board), searchPly(0), nSearched(0)
+        Search(Board * board, const SearchOptions& opts = SearchOptions(),
+               TT::Table * table = &TT::table)
+        : bestMove(Move()), options(opts), _board(board), _tt(table), _out(&std::cout)
+        , pvIndex(0), searchPly(0), contHistory(new ContHistory[2]()), nSearched(0), nResearches(0)
         { }
 
         /*
          *  search.cpp
          */
         
+        static void init();
         void think(int);
+        void think(const SearchLimits&);
+        int aspirationSearch(int, int);
         
         template<bool> int negamax(int, int, int, bool=true, bool=true);
         int quiesce(int, int);
         template<bool> U64 perft(int);
 
         void reset();
+        inline U64 getNodes() const { return nSearched; }
+        inline U32 getResearches() const { return nResearches; }
+        static inline int getReduction(int depth, int n) { return reductions[depth][n]; }
+        inline int getHistory(Color c, PieceType pt, Square sq) const { return history[c][pt-1][sq]; }
+        inline Move getCounterMove(Color c, PieceType pt, Square sq) const { return counterMoves[c][pt-1][sq]; }
+        template<typename T> static void applyGravity(T&, int);
+        void setOutput(std::ostream*);
+        inline void setBoard(Board * board) { _board = board; }
+        inline void setDebug(bool on) { debug = on; }
         void sortMoves(std::vector<Move>&, Move = Move());
+        int getPV(Move*, int);
 
         Move bestMove;
         int bestScore = 0;
+        int bestDepth = 0;
+        int bestMoveTime = 0;
+        U64 bestMoveNodes = 0;
         const static int MAX_DEPTH = 64;
+        const static int ASPIRATION_WINDOW = 25;
+        const static int ASPIRATION_DEPTH = 5;
+        const static int RAZOR_DEPTH = 3;
+        const static int FUTILITY_DEPTH = 2;
+        const static int REVERSE_FUTILITY_DEPTH = 6;
+        const static int MAX_MOVES = 64;
+        const static int HISTORY_REDUCTION_DIVISOR = 16384;
+        const static int HISTORY_MAX = 16384;
+        const static int HISTORY_MAX_BONUS = 1200;
+        const static int CURRMOVE_DELAY = 1000;
+        const static int MATE_DEPTH_MARGIN = 4;
+        const static int TIME_CHECK_INTERVAL = 1023;
+
+        SearchOptions options;
+
+        // Principal variations found by the last search, best first
+        // More than one line is only searched in MultiPV mode
+        struct PVLine {
+            Move move;
+            int score = 0;
+            int length = 0;
+            Move moves[MAX_DEPTH];
+        };
+        std::vector<PVLine> pvLines;
+        std::vector<RootMove> rootMoves;
 
     private:
-        // Board to search
+        // Board to search, its transposition table, and the search output
         Board * _board;
+        TT::Table * _tt;
+        std::ostream * _out;
+
+        // Late move reduction table, indexed by depth and move number
+        static int reductions[MAX_DEPTH][MAX_MOVES];
 
         // Main search variables
-        std::vector<Move> pv[MAX_DEPTH];
+        int pvIndex;
+        Move pvTable[MAX_DEPTH + 1][MAX_DEPTH + 1];
+        int pvLength[MAX_DEPTH + 1];
         I32 searchPly;
-        U32 history[2][6][64];
+        I32 history[2][6][64];
         Killer killers[MAX_DEPTH];
+        Move counterMoves[2][6][64];
+        std::unique_ptr<ContHistory[]> contHistory;
+
+        // Moves made at each ply of the search, and the piece moved
+        Move plyMove[MAX_DEPTH];
+        PieceType plyPiece[MAX_DEPTH];
+
+        // Search limits, and whether they stopped the search
+        SearchLimits limits;
+        bool stopped = false;
 
         // Search statistics variables
-        U32 nSearched;
+        U64 nSearched;
+        U32 nResearches;
+
+        // In debug mode, how often quiescence evals were cut short, how
+        // often the full eval would have decided differently, and the
+        // largest terms left out
+        struct LazyEvalStats {
+            U64 evals = 0;
+            U64 lazy = 0;
+            U64 noMobility = 0;
+            U64 errors = 0;
+            int maxGap = 0;
+            int maxMobilityGap = 0;
+        };
+        bool debug = false;
+        LazyEvalStats lazyStats;
+
+        // Static evals of positions seen by this search, and how often
+        // one was found there or in the transposition table
+        Eval::Cache evalCache;
+        U64 evalProbes = 0;
+        U64 evalHits = 0;
+
+        // Positions scored by the tablebases
+        U64 tbHits = 0;
         std::chrono::high_resolution_clock::time_point start, stop;
 
         // Helper methods
-        void addToHistory(Move move, int ply);
+        U64 evalKey() const;
+        int evaluate(const TT::Entry*);
+        void addToHistory(Move, int, Move*, int);
+        void updateHistory(Move, int);
+        int quietHistory(Move, PieceType) const;
+        bool isExcludedRootMove(Move) const;
+        void verifyLazyEval(bool, int, int, int);
         void savePV(Move move);
-        void printPV(int, int, unsigned int);
+        int elapsed();
+        void printPV(int, int, NodeType);
 };
 
+// Move a history entry towards the bonus, scaled so it stays within
+// [-HISTORY_MAX, HISTORY_MAX] without needing to age the table
+template<typename T>
+inline void Search::applyGravity(T& entry, int bonus)
+{
+    entry += bonus - entry * abs(bonus) / HISTORY_MAX;
+}
+
 #endif
\ No newline at end of file
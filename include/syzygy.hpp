@@ -0,0 +1,59 @@
+#ifndef ANTONIUS_SYZYGY_H
+#define ANTONIUS_SYZYGY_H
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+class Board;
+class Move;
+
+// Syzygy tablebases, probing the win/draw/loss tables (.rtbw) and the
+// distance to zeroing tables (.rtbz)
+// https://github.com/syzygy1/tb
+// The decoder has only been tested on tables written by SyzygyTest, so
+// the search does not use it until it is checked against published ones
+// Tables are mapped and parsed when loaded, and only read while probing,
+// so probes take no locks and are safe from any number of searches
+namespace Syzygy
+{
+
+    const int MAX_PIECES = 7;
+
+    // Results for the side to move, where cursed wins and blessed losses
+    // are the wins and losses that the fifty move rule turns into draws
+    enum WDL : int {
+        LOSS = -2,
+        BLESSED_LOSS = -1,
+        DRAW = 0,
+        CURSED_WIN = 1,
+        WIN = 2
+    };
+
+    // Won positions score below any mate the search can find
+    const int WIN_SCORE = MATESCORE - 2000;
+
+    // Map the tables of a list of directories separated by ':', replacing
+    // those loaded before, and return how many win/draw/loss tables were found
+    int load(const std::string&);
+    void clear();
+
+    // The most pieces of any loaded table
+    int largest();
+
+    // The result of a position for the side to move, or false if it has
+    // no table. Captures are searched, as tables may store any value for
+    // positions with a winning capture
+    bool probeWDL(Board&, WDL&);
+
+    // The plies to the next capture or pawn move of a won position,
+    // negative for a lost one and zero for a draw
+    bool probeDTZ(Board&, int&);
+
+    // Rank legal root moves by their result and distance to zeroing,
+    // higher being better, or false if the root has no table
+    bool rankRootMoves(Board&, const std::vector<Move>&, std::vector<int>&);
+
+}
+
+#endif
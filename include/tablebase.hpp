@@ -0,0 +1,71 @@
+#ifndef ANTONIUS_TABLEBASE_H
+#define ANTONIUS_TABLEBASE_H
+
+#include <string>
+#include "types.hpp"
+
+class Board;
+
+// Endgame tablebases generated locally by retrograde analysis, one file
+// per material combination holding the distance to mate of every position
+// Antonius tablebase generate --tables KQKR,KRPKR --path tb --threads 8
+// Antonius tablebase generate --pieces 4 --path tb
+namespace Tablebase
+{
+
+    const int MAX_PIECES = 5;
+
+    // Files are named after their material, strong side first, and hold a
+    // header then one byte per position: 0 for a draw, the moves to mate
+    // for a win, or 128 plus the moves to be mated for a loss
+    const std::string EXTENSION = ".atb";
+
+    struct Header
+    {
+        char magic[4];
+        U8 pieces;
+        U8 reserved[3];
+        char code[8];
+        U64 size;       // Positions, including both sides to move
+    };
+    static_assert(sizeof(Header) == 24, "Headers are 24 bytes");
+
+    struct Options
+    {
+        VecStr tables;
+        int pieces = 0;
+        std::string path = ".";
+        unsigned threads = 1;
+    };
+
+    // The code of a material combination, with the stronger side first
+    // and each side's pieces in the order QRBNP, such as "KRPKR"
+    std::string normalize(const std::string&);
+
+    // Every material combination of up to a number of pieces, kings included
+    VecStr combinations(int);
+
+    // Generate a table and any table it converts to by captures and
+    // promotions that is not already in the path, returning false if the
+    // code is not a valid material combination
+    bool generate(const std::string&, const std::string&, unsigned);
+
+    // Map the tables of a directory, replacing those loaded before, and
+    // return how many were found
+    int load(const std::string&);
+    void clear();
+
+    // The most pieces of any loaded table
+    int largest();
+
+    // The score of a position for the side to move, mate scores counted
+    // from the given ply, or false if it has no table
+    // Castling rights and en passant squares are left to the search
+    bool probe(const Board&, int&, int = 0);
+
+    Options parseArgs(const VecStr&);
+    int main(const VecStr&);
+
+}
+
+#endif
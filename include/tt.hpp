@@ -7,6 +7,9 @@
 
 namespace TT {
 
+    // Marks an entry saved without a static eval
+    const int NO_EVAL = -32768;
+
     struct Entry
     {
 
@@ -16,11 +19,12 @@ namespace TT {
         NodeType    flag;
         U8          depth;
         U8          age;
+        I16         eval;
 
         Entry() = default;
 
-        Entry(U64 _zkey, int _score, U8 _depth, NodeType _flag, Move _best)
-        : zkey(_zkey), score(_score), best(_best), flag(_flag), depth(_depth), age(0)
+        Entry(U64 _zkey, int _score, U8 _depth, NodeType _flag, Move _best, int _eval = NO_EVAL)
+        : zkey(_zkey), score(_score), best(_best), flag(_flag), depth(_depth), age(0), eval((I16)_eval)
         { }
 
         friend std::ostream& operator<<(std::ostream&, const Entry&);
@@ -33,20 +37,24 @@ namespace TT {
     {
     private:
 
-        Entry * _table;
-        U32 _size = 0;
+        Entry * _table = nullptr;
+        size_t _size = 0;
 
     public:
 
-        void init(U32);
-        void save(U64, U8, int, NodeType, Move);
+        void init(size_t);
+        void clear();
+        void save(U64, U8, int, NodeType, Move, int = NO_EVAL);
         Entry * probe(U64) const;
 
-        Table()
+        Table(size_t nbytes = 16777216)
         {
-            init(16777216);
+            init(nbytes);
         }
 
+        Table(const Table&) = delete;
+        Table& operator=(const Table&) = delete;
+
         ~Table()
         {
             delete [] _table;
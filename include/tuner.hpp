@@ -0,0 +1,105 @@
+#ifndef ANTONIUS_TUNER_H
+#define ANTONIUS_TUNER_H
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "types.hpp"
+
+class Board;
+
+// Texel's tuning method for the evaluation parameters, fitted to the
+// results of quiet labelled positions, written back as evalparams.hpp
+// https://www.chessprogramming.org/Texel%27s_Tuning_Method
+// Antonius tune --input positions.epd --output include/evalparams.hpp --threads 4
+namespace Tuner
+{
+
+    // Offsets of the evaluation terms in the parameter vector
+    // Tapered terms hold their opening values before their endgame values
+    enum Param : U16 {
+        MOBILITY           = 0,                          // [phase][piece]
+        PASSED_PAWN        = MOBILITY + 2*6,             // [phase]
+        DOUBLE_PAWN        = PASSED_PAWN + 2,
+        TRIPLE_PAWN        = DOUBLE_PAWN + 2,
+        ISO_PAWN           = TRIPLE_PAWN + 2,
+        OPEN_FILE          = ISO_PAWN + 2,
+        HALF_OPEN_FILE     = OPEN_FILE + 2,
+        BISHOP_PAIR        = HALF_OPEN_FILE + 2,
+        TEMPO              = BISHOP_PAIR + 2,
+        KNIGHT_PAWN,
+        ROOK_PAWN,
+        CONNECTED_ROOK,
+        ROOK_ON_SEVENTH,
+        BACK_RANK_MINOR,
+        MINOR_OUTPOST,
+        STRONG_KING_SHIELD,
+        WEAK_KING_SHIELD,
+        KING_ATTACK,
+        PIECE_VALUE,                                     // [piece], pawn to queen
+        KNIGHT_TROPISM     = PIECE_VALUE + 5,            // [distance]
+        BISHOP_TROPISM     = KNIGHT_TROPISM + 8,
+        ROOK_TROPISM       = BISHOP_TROPISM + 8,
+        QUEEN_TROPISM      = ROOK_TROPISM + 8,
+        PIECE_SQUARE       = QUEEN_TROPISM + 8,          // [piece][phase][square]
+        NPARAMS            = PIECE_SQUARE + 6*2*64,
+        NO_PARAM           = 0xffff
+    };
+
+    using Params = std::vector<double>;
+
+    // A term of the evaluation, linear in one parameter, or tapered
+    // between an opening and an endgame parameter by the game phase
+    struct Feature
+    {
+        U16 op;
+        U16 eg;
+        float coef;
+    };
+
+    // Positions reduced to their features, with the game result for white
+    struct Dataset
+    {
+        std::vector<Feature> features;
+        std::vector<U32> ends;
+        std::vector<float> phases;
+        std::vector<float> results;
+
+        inline size_t size() const { return results.size(); }
+    };
+
+    struct Options
+    {
+        std::string input;
+        std::string output = "include/evalparams.hpp";
+        unsigned threads = 1;
+        int epochs = 1000;
+        double rate = 1.0;
+        double K = 0;
+    };
+
+    struct Stats
+    {
+        U64 lines = 0;
+        U64 positions = 0;
+        double K = 0;
+        double startLoss = 0;
+        double loss = 0;
+    };
+
+    Params defaults();
+    void extract(const Board&, std::vector<Feature>&);
+    double evaluate(const Params&, const Feature*, const Feature*, double);
+
+    std::vector<Dataset> load(const std::string&, unsigned, Stats&);
+    double loss(const std::vector<Dataset>&, const Params&, double);
+    double fitK(const std::vector<Dataset>&, const Params&);
+    Stats tune(const Options&, Params&, std::ostream&);
+    void write(std::ostream&, const Params&);
+
+    Options parseArgs(const VecStr&);
+    int main(const VecStr&);
+
+}
+
+#endif
@@ -4,12 +4,20 @@
 #include <string>
 #include "board.hpp"
 #include "search.hpp"
+#include "polyglot.hpp"
 
 // Universal Chess Interface (UCI)
 // http://wbec-ridderkerk.nl/html/UCIProtocol.html
 namespace UCI
 {
 
+	// Time management: the moves a clock is shared over when the GUI does
+	// not say, the milliseconds kept for communication, and the time given
+	// to a search without limits, which cannot be stopped once started
+	const int MOVES_TO_GO = 30;
+	const int MOVE_OVERHEAD = 50;
+	const int DEFAULT_MOVETIME = 10000;
+
 	class Controller 
 	{
 
@@ -19,19 +27,26 @@ namespace UCI
 		void loop();
 		bool execute(const std::string& input);
 
+		inline const SearchOptions& options() const { return search.options; }
+
 	private:
 
 		Board 	board;
 		Search 	search;
 		bool 	_debug;
+		bool 	ownBook;
+		std::string 	bookFile;
+		Polyglot::Book 	book;
 		std::istream& istream;
 		std::ostream& ostream;
 
 		void uci();
 		void setdebug(VecStr& tokens);
+		void setoption(VecStr& tokens);
 		void position(VecStr& tokens);
 		void go(VecStr& tokens);
 		void move(VecStr& tokens);
+		void epd(VecStr& tokens);
 		void moves();
 
 	};
@@ -13,6 +13,11 @@ namespace Zobrist
     extern U64 ep[8];
     extern U64 castle[NCOLORS][2];
 
+    // Keyed by the number of pieces of a type, so that the material key
+    // only depends on the piece counts
+    const int MAX_PIECES = 16;
+    extern U64 material[NCOLORS][NPIECETYPES][MAX_PIECES];
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "analysis.hpp"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include "board.hpp"
+#include "epd.hpp"
+#include "tt.hpp"
+
+using namespace std::chrono;
+
+namespace Analysis {
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--input")
+                options.input = value;
+            else if (flag == "--output")
+                options.output = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else if (flag == "--hash")
+                options.hashBytes = (size_t)std::stoull(value) << 20;
+            else if (flag == "--depth")
+                options.limits.depth = std::stoi(value);
+            else if (flag == "--nodes")
+                options.limits.nodes = std::stoull(value);
+            else if (flag == "--movetime")
+                options.limits.movetime = std::stoi(value);
+            else if (flag == "--multipv")
+                options.searchOptions.multiPV = std::max(1, std::stoi(value));
+            else
+                continue;
+
+            i++;
+        }
+
+        // Default to a fixed depth, so that results are reproducible
+        if (!options.limits.depth && !options.limits.nodes && !options.limits.movetime)
+            options.limits.depth = 10;
+
+        return options;
+    }
+
+    static std::string escape(const std::string& str)
+    {
+        std::string escaped;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Format a search result as a single JSON object
+    static std::string toJSON(U64 index, const EPD::Position& position, Search& search)
+    {
+        std::ostringstream oss;
+        oss << "{\"index\":" << index;
+        if (!position.id.empty())
+            oss << ",\"id\":\"" << escape(position.id) << "\"";
+        oss << ",\"fen\":\"" << escape(position.fen.substr(0, position.fen.find_last_not_of(' ') + 1)) << "\"";
+
+        if (search.bestMove.isNullMove())
+            oss << ",\"bestmove\":null";
+        else
+            oss << ",\"bestmove\":\"" << search.bestMove << "\"";
+
+        int score = search.bestScore;
+        if (abs(score) > MATESCORE - 1000)
+        {
+            int mateIn = (MATESCORE - abs(score) + 1) / 2;
+            oss << ",\"score\":{\"mate\":" << (score > 0 ? mateIn : -mateIn) << "}";
+        }
+        else
+            oss << ",\"score\":{\"cp\":" << score << "}";
+
+        oss << ",\"depth\":" << search.bestDepth;
+        oss << ",\"pv\":[";
+        if (!search.pvLines.empty())
+        {
+            auto& line = search.pvLines[0];
+            for (int i = 0; i < line.length; i++)
+                oss << (i ? "," : "") << "\"" << line.moves[i] << "\"";
+        }
+        oss << "],\"nodes\":" << search.getNodes() << "}";
+
+        return oss.str();
+    }
+
+    Stats run(const Options& options, std::istream& is, std::ostream& os)
+    {
+        Stats stats;
+        U64 nLines = 0;
+        std::mutex inputMutex,
+                   outputMutex;
+        auto start = high_resolution_clock::now();
+
+        // Each worker keeps a board, search and transposition table for the
+        // whole run, reading the next line and writing its result as soon
+        // as it is done, so results are not in input order. The table is
+        // cleared for each position, so results do not depend on which
+        // worker searched which positions before
+        auto worker = [&]()
+        {
+            TT::Table table(options.hashBytes);
+            Board board(G::STARTFEN);
+            Search search(&board, options.searchOptions, &table);
+            search.setOutput(nullptr);
+
+            std::string line;
+            U64 index,
+                nPositions = 0,
+                nNodes = 0;
+
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(inputMutex);
+                    if (!std::getline(is, line))
+                        break;
+                    index = nLines++;
+                }
+
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+
+                auto position = EPD::parse(line);
+                board = Board(position.fen);
+                table.clear();
+                search.think(options.limits);
+                auto json = toJSON(index, position, search);
+
+                nPositions++;
+                nNodes += search.getNodes();
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                os << json << '\n';
+            }
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            stats.positions += nPositions;
+            stats.nodes += nNodes;
+            os.flush();
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < std::max(1u, options.threads); i++)
+            workers.emplace_back(worker);
+        for (auto& thread : workers)
+            thread.join();
+
+        stats.seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        return stats;
+    }
+
+    int main(const VecStr& args)
+    {
+        Options options = parseArgs(args);
+
+        std::ifstream ifs;
+        std::ofstream ofs;
+        if (options.input != "-")
+        {
+            ifs.open(options.input);
+            if (!ifs)
+            {
+                std::cerr << "Cannot open " << options.input << std::endl;
+                return 1;
+            }
+        }
+        if (options.output != "-")
+            ofs.open(options.output);
+
+        std::istream& is = options.input != "-" ? ifs : std::cin;
+        std::ostream& os = options.output != "-" ? ofs : std::cout;
+
+        Stats stats = run(options, is, os);
+
+        // Report throughput on stderr, keeping the output plain JSON lines
+        double pps = stats.positions / std::max(stats.seconds, 1e-9);
+        std::cerr << "positions " << stats.positions
+                  << " time " << (int)(stats.seconds * 1000)
+                  << " pps " << (U64)pps
+                  << " pps/core " << (U64)(pps / std::max(1u, options.threads))
+                  << " nps " << (U64)(stats.nodes / std::max(stats.seconds, 1e-9))
+                  << std::endl;
+
+        return 0;
+    }
+
+}
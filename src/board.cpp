@@ -6,6 +6,7 @@
 #include <vector>
 #include "types.hpp"
 #include "movegen.hpp"
+#include "polyglot.hpp"
 
 // Create a board using a FEN string
 // See: https://www.chessprogramming.org/Forsyth-Edwards_Notation
@@ -16,6 +17,7 @@ Board::Board(const std::string& fen)
     , openingScore{0}
     , endgameScore{0}
     , materialScore{0}
+    , materialKey{0}
 {
     for (int i = 0; i < 7; i++) {
         pieces[BLACK][i] = BB(0x0UL);
@@ -155,33 +157,44 @@ BB Board::getCheckBlockers(Color c, Color kingC) const
     return blockers;
 }
 
-int Board::calculateMobilityScore(const int opPhase, const int egPhase) const
+// Mobility from the moves counted while building the attack maps
+int Board::calculateMobilityScore(const Eval::Attacks& attacks, const int opPhase, const int egPhase) const
 {
-    int score = 0;
-    score += calculateMobilityScore<KNIGHT>(opPhase, egPhase);
-    score += calculateMobilityScore<BISHOP>(opPhase, egPhase);
-    score += calculateMobilityScore<ROOK  >(opPhase, egPhase);
-    score += calculateMobilityScore<QUEEN >(opPhase, egPhase);
-    return score;
+    int mobilityScore = 0;
+    for (PieceType pt : { KNIGHT, BISHOP, ROOK, QUEEN })
+    {
+        int moves = attacks.moves[WHITE][pt] - attacks.moves[BLACK][pt];
+        mobilityScore += moves * (opPhase * Eval::MobilityScaling[OPENING][pt-1]
+                                + egPhase * Eval::MobilityScaling[ENDGAME][pt-1]);
+    }
+    return mobilityScore;
 }
 
-template<PieceType pt>
-int Board::calculateMobilityScore(const int opPhase, const int egPhase) const
+// Danger to the king of the given color, from the pieces attacking the
+// squares around it and the checks they can give without being taken
+int Board::calculateKingDanger(Color c, const Eval::Attacks& attacks) const
 {
-    int mobilityScore = 0;
-    BB occ = occupancy();
-
-    int whitemoves = MoveGen::mobility<pt>(getPieces<pt>(WHITE),
-                                          ~getPieces<ALL>(WHITE), occ);
-    mobilityScore += whitemoves * (opPhase * Eval::MobilityScaling[OPENING][pt-1]
-                                 + egPhase * Eval::MobilityScaling[ENDGAME][pt-1]);
-    
-    int blackmoves = MoveGen::mobility<pt>(getPieces<pt>(BLACK),
-                                          ~getPieces<ALL>(BLACK), occ);
-    mobilityScore -= blackmoves * (opPhase * Eval::MobilityScaling[OPENING][pt-1]
-                                 + egPhase * Eval::MobilityScaling[ENDGAME][pt-1]);
-    
-    return mobilityScore;
+    Color them = ~c;
+    if (attacks.kingAttackers[them] < 2)
+        return 0;
+
+    Square king = getKingSq(c);
+    BB occ = occupancy(),
+       safe = ~attacks.all[c] & ~getPieces<ALL>(them),
+       diagonal = MoveGen::movesByPiece<BISHOP>(king, occ),
+       straight = MoveGen::movesByPiece<ROOK>(king, occ);
+
+    int units = attacks.kingAttackUnits[them];
+    if (BB(G::KNIGHT_ATTACKS[king]) & attacks.byType[them][KNIGHT] & safe)
+        units += Eval::SafeCheckUnits[KNIGHT];
+    if (diagonal & attacks.byType[them][BISHOP] & safe)
+        units += Eval::SafeCheckUnits[BISHOP];
+    if (straight & attacks.byType[them][ROOK] & safe)
+        units += Eval::SafeCheckUnits[ROOK];
+    if ((diagonal | straight) & attacks.byType[them][QUEEN] & safe)
+        units += Eval::SafeCheckUnits[QUEEN];
+
+    return Eval::KingDanger[std::min(units, 99)];
 }
 
 int Board::calculatePieceScore() const
@@ -434,6 +447,19 @@ void Board::loadFENCastle(const std::string& castle)
     }
 }
 
+// The material key depends only on how many pieces of each kind are left
+U64 Board::calculateMaterialKey() const
+{
+    U64 key = 0x0;
+
+    for (Color c : { WHITE, BLACK })
+        for (int pt = PAWN; pt <= KING; pt++)
+            for (int i = 0; i < pieceCount[c][pt]; i++)
+                key ^= Zobrist::material[c][pt-1][i];
+
+    return key;
+}
+
 U64 Board::calculateKey() const
 {
     U64 zkey = 0x0;
@@ -470,4 +496,41 @@ U64 Board::calculateKey() const
         zkey ^= Zobrist::castle[BLACK][QUEENSIDE];
 
     return zkey;
+}
+
+// Calculate the key of the position in Polyglot opening books
+U64 Board::calculatePolyglotKey() const
+{
+    U64 key = 0x0;
+
+    for (auto sq = A1; sq != INVALID; sq++)
+    {
+        auto piece = getPiece(sq);
+
+        if (piece != EMPTY)
+        {
+            auto c = Types::getPieceColor(piece);
+            auto pt = Types::getPieceType(piece);
+            key ^= Polyglot::random[64 * (2 * (pt - 1) + c) + sq];
+        }
+    }
+
+    if (canCastleOO(WHITE))
+        key ^= Polyglot::random[Polyglot::CASTLE_KEYS];
+    if (canCastleOOO(WHITE))
+        key ^= Polyglot::random[Polyglot::CASTLE_KEYS + 1];
+    if (canCastleOO(BLACK))
+        key ^= Polyglot::random[Polyglot::CASTLE_KEYS + 2];
+    if (canCastleOOO(BLACK))
+        key ^= Polyglot::random[Polyglot::CASTLE_KEYS + 3];
+
+    // The en passant file only counts if a pawn can capture there
+    auto sq = getEnPassant();
+    if (sq != INVALID && (getPieces<PAWN>(stm) & MoveGen::attacksByPawns(BB(G::bitset(sq)), ~stm)))
+        key ^= Polyglot::random[Polyglot::ENPASSANT_KEYS + Types::getFile(sq)];
+
+    if (stm == WHITE)
+        key ^= Polyglot::random[Polyglot::TURN_KEY];
+
+    return key;
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "bookbuilder.hpp"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include "pgn.hpp"
+#include "polyglot.hpp"
+
+namespace BookBuilder {
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--input")
+                options.input = value;
+            else if (flag == "--output")
+                options.output = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else if (flag == "--memory")
+                options.memory = (size_t)std::stoull(value) << 20;
+            else if (flag == "--max-ply")
+                options.maxPly = std::stoi(value);
+            else if (flag == "--min-games")
+                options.minGames = (U32)std::stoul(value);
+            else if (flag == "--max-open-runs")
+                options.maxOpenRuns = std::max(2u, (unsigned)std::stoul(value));
+            else
+                continue;
+
+            i++;
+        }
+
+        return options;
+    }
+
+    static inline void add(Record& a, const Record& b)
+    {
+        a.wins += b.wins;
+        a.draws += b.draws;
+        a.losses += b.losses;
+    }
+
+    // Sort a buffer and collapse duplicate moves, then write it as a run
+    static void writeRun(std::vector<Record>& buffer, const std::string& filename)
+    {
+        std::sort(buffer.begin(), buffer.end());
+
+        std::ofstream ofs(filename, std::ios::binary);
+        for (size_t i = 0; i < buffer.size(); )
+        {
+            Record record = buffer[i++];
+            while (i < buffer.size() && buffer[i].key == record.key && buffer[i].move == record.move)
+                add(record, buffer[i++]);
+
+            ofs.write(reinterpret_cast<const char*>(&record), sizeof(Record));
+        }
+
+        buffer.clear();
+    }
+
+    // Reads a sorted run back, one record at a time
+    struct RunReader
+    {
+        std::ifstream is;
+        Record current;
+
+        explicit RunReader(const std::string& filename)
+            : is(filename, std::ios::binary)
+        { }
+
+        bool next()
+        {
+            return (bool)is.read(reinterpret_cast<char*>(&current), sizeof(Record));
+        }
+    };
+
+    // Merge sorted runs, passing records to the callback in order with
+    // the same move collapsed across runs
+    template<typename F>
+    static void mergeRuns(const std::vector<std::string>& runs, F&& onRecord)
+    {
+        std::vector<std::unique_ptr<RunReader>> readers;
+        auto greater = [&](unsigned a, unsigned b) { return readers[b]->current < readers[a]->current; };
+        std::priority_queue<unsigned, std::vector<unsigned>, decltype(greater)> heap(greater);
+
+        for (auto& run : runs)
+        {
+            readers.push_back(std::make_unique<RunReader>(run));
+            if (readers.back()->next())
+                heap.push((unsigned)readers.size() - 1);
+        }
+
+        bool hasRecord = false;
+        Record merged = {};
+        while (!heap.empty())
+        {
+            unsigned i = heap.top();
+            heap.pop();
+            Record record = readers[i]->current;
+            if (readers[i]->next())
+                heap.push(i);
+
+            if (hasRecord && merged.key == record.key && merged.move == record.move)
+                add(merged, record);
+            else
+            {
+                if (hasRecord)
+                    onRecord(merged);
+                merged = record;
+                hasRecord = true;
+            }
+        }
+
+        if (hasRecord)
+            onRecord(merged);
+    }
+
+    // Write the moves of a position, best first, weighted 2 per win and
+    // 1 per draw, scaled down to fit in 16 bits
+    static void writePosition(std::ostream& os, std::vector<Record>& moves, U32 minGames, Stats& stats)
+    {
+        std::vector<std::pair<U64, U16>> weights;
+        U64 maxWeight = 0;
+
+        for (auto& record : moves)
+        {
+            U64 weight = 2 * (U64)record.wins + record.draws;
+            if (weight == 0 || record.wins + record.draws + record.losses < minGames)
+                continue;
+
+            maxWeight = std::max(maxWeight, weight);
+            weights.emplace_back(weight, record.move);
+        }
+
+        std::stable_sort(weights.begin(), weights.end(),
+                         [](const std::pair<U64, U16>& a, const std::pair<U64, U16>& b) { return a.first > b.first; });
+
+        for (auto& weight : weights)
+        {
+            U16 scaled = (U16)std::max<U64>(1, weight.first * 0xffff / std::max<U64>(maxWeight, 0xffff));
+            Polyglot::writeEntry(os, { moves.front().key, weight.second, scaled, 0 });
+            stats.entries++;
+        }
+
+        moves.clear();
+    }
+
+    Stats build(const Options& options)
+    {
+        Stats stats;
+
+        MappedFile file(options.input);
+        if (!file.isOpen())
+            return stats;
+
+        // Parse games in parallel, each thread filling a buffer of its
+        // share of the memory budget before spilling it as a sorted run
+        size_t runSize = std::max<size_t>(1, options.memory / options.threads / sizeof(Record));
+        std::vector<std::vector<Record>> buffers(options.threads);
+        std::vector<std::string> runs;
+        std::mutex runMutex;
+        std::atomic<U64> nGames(0),
+                         nPositions(0);
+
+        auto spill = [&](std::vector<Record>& buffer)
+        {
+            std::string filename;
+            {
+                std::lock_guard<std::mutex> lock(runMutex);
+                filename = options.output + ".run" + std::to_string(runs.size());
+                runs.push_back(filename);
+            }
+            writeRun(buffer, filename);
+        };
+
+        PGN::parallelForEach(file.text(), options.threads, [&](unsigned thread, const PGN::Game& game)
+        {
+            // Only decisive and drawn games count
+            int whiteScore = game.result == "1-0" ? 1 : game.result == "0-1" ? -1
+                           : game.result == "1/2-1/2" ? 0 : 2;
+            if (whiteScore == 2)
+                return;
+
+            auto& buffer = buffers[thread];
+            int ply = 0;
+
+            PGN::replay(game, [&](Board& board, Move move)
+            {
+                if (ply++ >= options.maxPly)
+                    return;
+
+                int score = board.sideToMove() == WHITE ? whiteScore : -whiteScore;
+                buffer.push_back({ board.calculatePolyglotKey(), Polyglot::encodeMove(move),
+                                   score > 0, score == 0, score < 0 });
+                nPositions++;
+
+                if (buffer.size() >= runSize)
+                    spill(buffer);
+            });
+
+            nGames++;
+        });
+
+        for (auto& buffer : buffers)
+            if (!buffer.empty())
+                spill(buffer);
+
+        stats.games = nGames;
+        stats.positions = nPositions;
+        stats.runs = runs.size();
+
+        // Merge groups of runs into longer runs until few enough are left
+        // to be open at once
+        size_t nextRun = runs.size();
+        unsigned maxOpen = std::max(2u, options.maxOpenRuns);
+        while (runs.size() > maxOpen)
+        {
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < runs.size(); first += maxOpen)
+            {
+                std::vector<std::string> group(runs.begin() + (long)first,
+                                               runs.begin() + (long)std::min(runs.size(), first + maxOpen));
+                if (group.size() == 1)
+                {
+                    merged.push_back(group.front());
+                    continue;
+                }
+
+                std::string filename = options.output + ".run" + std::to_string(nextRun++);
+                {
+                    std::ofstream ofs(filename, std::ios::binary);
+                    mergeRuns(group, [&](const Record& record)
+                    {
+                        ofs.write(reinterpret_cast<const char*>(&record), sizeof(Record));
+                    });
+                }
+
+                for (auto& run : group)
+                    std::remove(run.c_str());
+                merged.push_back(filename);
+            }
+
+            runs = merged;
+            stats.passes++;
+        }
+
+        // Merge the last runs, and write each position's moves once all
+        // of them are known
+        std::ofstream ofs(options.output, std::ios::binary);
+        std::vector<Record> moves;
+
+        mergeRuns(runs, [&](const Record& record)
+        {
+            if (!moves.empty() && moves.back().key != record.key)
+                writePosition(ofs, moves, options.minGames, stats);
+            moves.push_back(record);
+        });
+
+        writePosition(ofs, moves, options.minGames, stats);
+        stats.passes++;
+
+        for (auto& run : runs)
+            std::remove(run.c_str());
+
+        return stats;
+    }
+
+    int main(const VecStr& args)
+    {
+        if (args.size() < 2 || args.at(1) != "build")
+        {
+            std::cerr << "Usage: Antonius book build --input <pgn> --output <bin>"
+                      << " [--threads N] [--memory MB] [--max-ply N] [--min-games N] [--max-open-runs N]" << std::endl;
+            return 1;
+        }
+
+        Options options = parseArgs(args);
+        if (!std::ifstream(options.input))
+        {
+            std::cerr << "Cannot open " << options.input << std::endl;
+            return 1;
+        }
+
+        Stats stats = build(options);
+        std::cerr << "games " << stats.games
+                  << " positions " << stats.positions
+                  << " runs " << stats.runs
+                  << " passes " << stats.passes
+                  << " entries " << stats.entries << std::endl;
+
+        return 0;
+    }
+
+}
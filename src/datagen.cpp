@@ -0,0 +1,295 @@
+#include "datagen.hpp"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include "board.hpp"
+#include "match.hpp"
+#include "mappedfile.hpp"
+
+namespace DataGen {
+
+    Record pack(const Board& board, int score, int result, int ply)
+    {
+        Record record = {};
+        BB occ = board.occupancy();
+        record.occupancy = occ;
+
+        unsigned i = 0;
+        while (occ)
+        {
+            Square sq = occ.lsb();
+            occ.clear(sq);
+            record.pieces[i / 2] |= (U8)(board.getPiece(sq) << (4 * (i % 2)));
+            i++;
+        }
+
+        record.score = (I16)std::max(-32767, std::min(32767, score));
+        record.ply = (U16)std::min(65535, ply);
+        record.result = (I8)result;
+        record.flags = (U8)(board.sideToMove()
+                     | (board.canCastleOOO(BLACK) ? BLACK_OOO << 1 : 0)
+                     | (board.canCastleOO(BLACK)  ? BLACK_OO  << 1 : 0)
+                     | (board.canCastleOOO(WHITE) ? WHITE_OOO << 1 : 0)
+                     | (board.canCastleOO(WHITE)  ? WHITE_OO  << 1 : 0));
+        record.hmClock = board.getHmClock();
+        record.enPassant = (U8)board.getEnPassant();
+
+        return record;
+    }
+
+    // The FEN of a packed position
+    std::string unpack(const Record& record)
+    {
+        Piece squares[64] = {};
+        BB occ = BB(record.occupancy);
+
+        unsigned i = 0;
+        while (occ)
+        {
+            Square sq = occ.lsb();
+            occ.clear(sq);
+            squares[sq] = Piece((record.pieces[i / 2] >> (4 * (i % 2))) & 0xf);
+            i++;
+        }
+
+        std::ostringstream oss;
+        for (int rank = RANK8; rank >= RANK1; rank--)
+        {
+            int emptyCount = 0;
+            for (int file = FILE1; file <= FILE8; file++)
+            {
+                Piece p = squares[8 * rank + file];
+                if (p == EMPTY)
+                {
+                    emptyCount++;
+                    continue;
+                }
+                if (emptyCount > 0)
+                    oss << emptyCount;
+                emptyCount = 0;
+                oss << Types::PieceChar[p];
+            }
+            if (emptyCount > 0)
+                oss << emptyCount;
+            if (rank != RANK1)
+                oss << '/';
+        }
+
+        int castle = record.flags >> 1;
+        oss << ((record.flags & 1) ? " w " : " b ");
+        if (castle & WHITE_OO)
+            oss << "K";
+        if (castle & WHITE_OOO)
+            oss << "Q";
+        if (castle & BLACK_OO)
+            oss << "k";
+        if (castle & BLACK_OOO)
+            oss << "q";
+        if (!castle)
+            oss << "-";
+
+        if (record.enPassant != INVALID)
+            oss << " " << Square(record.enPassant) << " ";
+        else
+            oss << " - ";
+
+        oss << +record.hmClock << " " << record.ply / 2 + 1;
+
+        return oss.str();
+    }
+
+    // Captures and promotions are left to the quiescence search, so the
+    // positions where one is the best move are not labelled by their eval
+    static bool isQuiet(const Board& board, Move move, int score, int maxScore)
+    {
+        return !board.isCheck()
+            && board.getPiece(move.to()) == EMPTY
+            && move.type() != PROMOTION
+            && move.type() != ENPASSANT
+            && std::abs(score) < maxScore;
+    }
+
+    Stats generate(const Options& options)
+    {
+        Stats stats;
+        std::ofstream ofs(options.output, std::ios::binary);
+        if (!ofs)
+            return stats;
+
+        std::mutex writeMutex;
+        std::atomic<U64> nextGame(0),
+                         nGames(0),
+                         nPositions(0),
+                         nSkipped(0);
+        auto start = std::chrono::steady_clock::now();
+
+        // Write a buffer of records, up to the number of positions asked for
+        auto flush = [&](std::vector<Record>& buffer)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            U64 n = std::min<U64>(buffer.size(), options.positions - nPositions);
+            ofs.write(reinterpret_cast<const char*>(buffer.data()), (std::streamsize)(n * sizeof(Record)));
+            nPositions += n;
+            buffer.clear();
+
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << "games " << nGames << " positions " << nPositions
+                      << " positions/s " << (U64)(nPositions / std::max(elapsed, 1e-3)) << std::endl;
+        };
+
+        auto worker = [&]()
+        {
+            Match::Options matchOptions;
+            matchOptions.limits = options.limits;
+            Match::Player player(Match::EngineConfig(), options.limits, options.hashBytes);
+
+            std::vector<Record> game, buffer;
+            while (nPositions < options.positions)
+            {
+                U64 index = nextGame++;
+                std::string fen = Match::opening({}, (options.seed << 32) + index, options.randomPlies);
+                int ply = options.randomPlies;
+
+                game.clear();
+                int result = Match::playGame(player, player, fen, matchOptions,
+                                             [&](const Board& board, Move move, int score)
+                {
+                    if (isQuiet(board, move, score, options.maxScore))
+                        game.push_back(pack(board, board.sideToMove() == WHITE ? score : -score, 0, ply));
+                    else
+                        nSkipped++;
+                    ply++;
+                });
+
+                for (auto& record : game)
+                    record.result = (I8)result;
+                buffer.insert(buffer.end(), game.begin(), game.end());
+                nGames++;
+
+                if (buffer.size() >= 4096)
+                    flush(buffer);
+            }
+
+            if (!buffer.empty())
+                flush(buffer);
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < options.threads; i++)
+            workers.emplace_back(worker);
+        for (auto& thread : workers)
+            thread.join();
+
+        stats.games = nGames;
+        stats.positions = nPositions;
+        stats.skipped = nSkipped;
+        return stats;
+    }
+
+    // Write the records of a file in a random order, so that consecutive
+    // positions no longer come from the same game
+    U64 shuffle(const Options& options)
+    {
+        MappedFile file(options.input);
+        if (!file.isOpen())
+            return 0;
+
+        const Record* records = reinterpret_cast<const Record*>(file.data());
+        U64 n = file.size() / sizeof(Record);
+
+        std::vector<U64> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(options.seed));
+
+        std::ofstream ofs(options.output, std::ios::binary);
+        std::vector<Record> buffer;
+        for (U64 i = 0; i < n; i++)
+        {
+            buffer.push_back(records[order[i]]);
+            if (buffer.size() == 4096 || i + 1 == n)
+            {
+                ofs.write(reinterpret_cast<const char*>(buffer.data()),
+                          (std::streamsize)(buffer.size() * sizeof(Record)));
+                buffer.clear();
+            }
+        }
+
+        return n;
+    }
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--input")
+                options.input = value;
+            else if (flag == "--output")
+                options.output = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else if (flag == "--positions")
+                options.positions = std::stoull(value);
+            else if (flag == "--nodes")
+                options.limits.nodes = std::stoull(value);
+            else if (flag == "--depth")
+                options.limits.depth = std::stoi(value);
+            else if (flag == "--hash")
+                options.hashBytes = (size_t)std::stoull(value) << 20;
+            else if (flag == "--random-plies")
+                options.randomPlies = std::stoi(value);
+            else if (flag == "--seed")
+                options.seed = std::stoull(value);
+            else if (flag == "--max-score")
+                options.maxScore = std::stoi(value);
+            else
+                continue;
+
+            i++;
+        }
+
+        if (!options.limits.depth && !options.limits.nodes)
+            options.limits.nodes = 2000;
+
+        return options;
+    }
+
+    int main(const VecStr& args)
+    {
+        Options options = parseArgs(args);
+
+        if (args.size() > 1 && args.at(1) == "shuffle")
+        {
+            if (!std::ifstream(options.input))
+            {
+                std::cerr << "Usage: Antonius datagen shuffle --input <bin> --output <bin> [--seed N]" << std::endl;
+                return 1;
+            }
+
+            U64 n = shuffle(options);
+            std::cerr << "shuffled " << n << " positions" << std::endl;
+            return 0;
+        }
+
+        Stats stats = generate(options);
+        std::cerr << "games " << stats.games
+                  << " positions " << stats.positions
+                  << " skipped " << stats.skipped << std::endl;
+
+        return stats.positions ? 0 : 1;
+    }
+
+}
@@ -0,0 +1,306 @@
+#include "endgame.hpp"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "globals.hpp"
+#include "board.hpp"
+#include "material.hpp"
+
+namespace Endgame {
+
+    /**
+     *  KPK bitbase
+     *  Positions are indexed with the strong side as white and its pawn on
+     *  files a to d, so 2 sides to move * 24 pawn squares * 64 * 64 king
+     *  squares, one bit each for whether white wins
+     */
+
+    const unsigned KPK_SIZE = 2 * 24 * 64 * 64;
+
+    static U32 kpk[KPK_SIZE / 32];
+
+    enum KPKResult : U8 {
+        INVALID = 0,
+        UNKNOWN = 1,
+        DRAW    = 2,
+        WIN     = 4
+    };
+
+    static inline unsigned kpkIndex(Color stm, Square bk, Square wk, Square pawn)
+    {
+        return unsigned(wk | (bk << 6) | (stm << 12) | (Types::getFile(pawn) << 13)
+                      | ((RANK7 - Types::getRank(pawn)) << 15));
+    }
+
+    static inline Square kpkPawn(unsigned i)
+    {
+        return Types::getSquare(File((i >> 13) & 3), RANK7 - int((i >> 15) & 7));
+    }
+
+    static inline U64 pawnAttacks(Square pawn)
+    {
+        U64 bb = G::SQUARE_BB[pawn];
+        return ((bb & ~G::FILE_MASK[FILE1]) << 7) | ((bb & ~G::FILE_MASK[FILE8]) << 9);
+    }
+
+    // The result of a position before looking at its moves
+    static KPKResult classifyStatic(Color stm, Square bk, Square wk, Square pawn)
+    {
+        Square promotion = Square(pawn + 8);
+
+        if (G::DISTANCE[wk][bk] <= 1 || wk == pawn || bk == pawn)
+            return INVALID;
+        if (stm == WHITE && (pawnAttacks(pawn) & G::SQUARE_BB[bk]))
+            return INVALID;
+
+        // The pawn promotes and the queen cannot be taken
+        if (stm == WHITE
+            && Types::getRank(pawn) == RANK7
+            && wk != promotion
+            && (G::DISTANCE[bk][promotion] > 1 || G::DISTANCE[wk][promotion] == 1))
+            return WIN;
+
+        // Stalemate, or the pawn is taken
+        U64 covered = G::KING_ATTACKS[wk] | pawnAttacks(pawn);
+        if (stm == BLACK
+            && (!(G::KING_ATTACKS[bk] & ~covered)
+                || (G::KING_ATTACKS[bk] & G::SQUARE_BB[pawn] & ~G::KING_ATTACKS[wk])))
+            return DRAW;
+
+        return UNKNOWN;
+    }
+
+    // The result of a position from the results of its moves
+    static KPKResult classify(const std::vector<U8>& db, Color stm, Square bk, Square wk, Square pawn)
+    {
+        U8 r = INVALID;
+        if (stm == WHITE)
+        {
+            U64 moves = G::KING_ATTACKS[wk];
+            while (moves)
+            {
+                Square to = Square(__builtin_ctzll(moves));
+                moves &= moves - 1;
+                r |= db[kpkIndex(BLACK, bk, to, pawn)];
+            }
+
+            Square push = Square(pawn + 8);
+            if (Types::getRank(pawn) < RANK7 && push != wk && push != bk)
+            {
+                r |= db[kpkIndex(BLACK, bk, wk, push)];
+
+                Square doublePush = Square(pawn + 16);
+                if (Types::getRank(pawn) == RANK2 && doublePush != wk && doublePush != bk)
+                    r |= db[kpkIndex(BLACK, bk, wk, doublePush)];
+            }
+
+            return (r & WIN) ? WIN : (r & UNKNOWN) ? UNKNOWN : DRAW;
+        }
+
+        U64 moves = G::KING_ATTACKS[bk];
+        while (moves)
+        {
+            Square to = Square(__builtin_ctzll(moves));
+            moves &= moves - 1;
+            r |= db[kpkIndex(WHITE, to, wk, pawn)];
+        }
+
+        return (r & DRAW) ? DRAW : (r & UNKNOWN) ? UNKNOWN : WIN;
+    }
+
+    // Classify every position, then repeat over the unknown ones until
+    // none changes
+    static void generateKPK()
+    {
+        std::vector<U8> db(KPK_SIZE);
+        for (unsigned i = 0; i < KPK_SIZE; i++)
+        {
+            Square wk = Square(i & 63),
+                   bk = Square((i >> 6) & 63),
+                   pawn = kpkPawn(i);
+            db[i] = classifyStatic(Color((i >> 12) & 1), bk, wk, pawn);
+        }
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (unsigned i = 0; i < KPK_SIZE; i++)
+            {
+                if (db[i] != UNKNOWN)
+                    continue;
+
+                Square wk = Square(i & 63),
+                       bk = Square((i >> 6) & 63),
+                       pawn = kpkPawn(i);
+                db[i] = classify(db, Color((i >> 12) & 1), bk, wk, pawn);
+                changed |= db[i] != UNKNOWN;
+            }
+        }
+
+        std::fill(std::begin(kpk), std::end(kpk), 0);
+        for (unsigned i = 0; i < KPK_SIZE; i++)
+            if (db[i] == WIN)
+                kpk[i / 32] |= 1u << (i % 32);
+    }
+
+    bool probeKPK(Color strong, Square strongKing, Square pawn, Square weakKing, Color stm)
+    {
+        // Look up the position with the strong side as white, and the
+        // pawn mirrored onto the queenside
+        if (strong == BLACK)
+        {
+            strongKing = Square(strongKing ^ 56);
+            weakKing = Square(weakKing ^ 56);
+            pawn = Square(pawn ^ 56);
+            stm = ~stm;
+        }
+        if (Types::getFile(pawn) >= FILE5)
+        {
+            strongKing = Square(strongKing ^ 7);
+            weakKing = Square(weakKing ^ 7);
+            pawn = Square(pawn ^ 7);
+        }
+
+        unsigned i = kpkIndex(stm, weakKing, strongKing, pawn);
+        return kpk[i / 32] & (1u << (i % 32));
+    }
+
+    /**
+     *  Evaluators, scoring an endgame for its strong side
+     */
+
+    // Drive the weak king to the edge and the strong king towards it
+    static inline int pushToEdge(Square sq)
+    {
+        int file = std::min<int>(Types::getFile(sq), FILE8 - Types::getFile(sq)),
+            rank = std::min<int>(Types::getRank(sq), RANK8 - Types::getRank(sq));
+        return 20 * (6 - file - rank);
+    }
+
+    static inline int pushClose(Square a, Square b)
+    {
+        return 140 - 20 * G::DISTANCE[a][b];
+    }
+
+    static int evaluateDraw(const Board&, Color)
+    {
+        return DRAWSCORE;
+    }
+
+    static int evaluateKPK(const Board& board, Color strong)
+    {
+        Square pawn = board.getPieces<PAWN>(strong).lsb();
+        if (!probeKPK(strong, board.getKingSq(strong), pawn, board.getKingSq(~strong), board.sideToMove()))
+            return DRAWSCORE;
+
+        int rank = strong == WHITE ? Types::getRank(pawn) : RANK8 - Types::getRank(pawn);
+        return KNOWN_WIN + PAWNSCORE + 10 * rank;
+    }
+
+    // A major piece against a bare king
+    static int evaluateKXK(const Board& board, Color strong)
+    {
+        Square strongKing = board.getKingSq(strong),
+               weakKing = board.getKingSq(~strong);
+        int material = board.count<QUEEN>(strong) * QUEENSCORE + board.count<ROOK>(strong) * ROOKSCORE;
+        return KNOWN_WIN + material + pushToEdge(weakKing) + pushClose(strongKing, weakKing);
+    }
+
+    // Mate can only be forced in a corner of the bishop's color
+    static int evaluateKBNK(const Board& board, Color strong)
+    {
+        Square strongKing = board.getKingSq(strong),
+               weakKing = board.getKingSq(~strong);
+        if (board.getPieces<BISHOP>(strong) & G::WHITESQUARES)
+            weakKing = Square(weakKing ^ 7);
+
+        // Highest in the a1 and h8 corners, and zero along a8-h1
+        int corner = std::abs(7 - Types::getRank(weakKing) - Types::getFile(weakKing));
+        return KNOWN_WIN + KNIGHTSCORE + BISHOPSCORE + 20 * corner
+             + pushClose(strongKing, board.getKingSq(~strong));
+    }
+
+    static std::unordered_map<U64, std::pair<Evaluator, Color>> evaluators;
+
+    static void add(const std::string& code, Evaluator evaluator)
+    {
+        evaluators[Material::key(code, WHITE)] = { evaluator, WHITE };
+        evaluators[Material::key(code, BLACK)] = { evaluator, BLACK };
+    }
+
+    void init()
+    {
+        if (!evaluators.empty())
+            return;
+
+        generateKPK();
+
+        add("KK",   evaluateDraw);
+        add("KNK",  evaluateDraw);
+        add("KBK",  evaluateDraw);
+        add("KNNK", evaluateDraw);
+        add("KPK",  evaluateKPK);
+        add("KRK",  evaluateKXK);
+        add("KQK",  evaluateKXK);
+        add("KBNK", evaluateKBNK);
+    }
+
+    bool find(U64 key, Evaluator& evaluator, Color& strong)
+    {
+        auto it = evaluators.find(key);
+        if (it == evaluators.end())
+            return false;
+
+        evaluator = it->second.first;
+        strong = it->second.second;
+        return true;
+    }
+
+    /**
+     *  Scalers, chosen by material and looking at the squares only once
+     *  the material matches
+     */
+
+    static int scaleOppositeBishops(const Board& board)
+    {
+        BB wBishops = board.getPieces<BISHOP>(WHITE),
+           bBishops = board.getPieces<BISHOP>(BLACK);
+        if (bool(wBishops & G::WHITESQUARES) != bool(bBishops & G::WHITESQUARES))
+            return SCALE_OPPOSITE_BISHOPS;
+
+        return SCALE_NORMAL;
+    }
+
+    Scaler findScaler(const Board& board)
+    {
+        // A bishop each, and no other pieces
+        if (board.getPieceCount(WHITE) == 1 && board.getPieceCount(BLACK) == 1
+            && board.count<BISHOP>(WHITE) == 1 && board.count<BISHOP>(BLACK) == 1)
+            return scaleOppositeBishops;
+
+        return nullptr;
+    }
+
+    bool probe(const Board& board, int& score)
+    {
+        const Material::Entry& entry = Material::probe(board);
+        if (!entry.evaluator)
+            return false;
+
+        score = entry.evaluate(board);
+        return true;
+    }
+
+    bool isKnownDraw(const Board& board)
+    {
+        int score;
+        return probe(board, score) && score == DRAWSCORE;
+    }
+
+    int scale(const Board& board)
+    {
+        return Material::probe(board).scale(board);
+    }
+
+}
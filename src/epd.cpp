@@ -0,0 +1,172 @@
+#include "epd.hpp"
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "board.hpp"
+#include "notation.hpp"
+#include "tt.hpp"
+
+using namespace std::chrono;
+
+namespace EPD {
+
+    Position parse(const std::string& line)
+    {
+        Position position;
+        auto tokens = G::split(line, ' ');
+
+        // The first four fields are the FEN, without move counters
+        unsigned i = 0;
+        for (; i < 4 && i < tokens.size(); i++)
+            position.fen += tokens.at(i) + " ";
+
+        // The rest are operations, "opcode operand...;"
+        std::string opcode = "";
+        for (; i < tokens.size(); i++)
+        {
+            std::string token = tokens.at(i);
+            if (token.empty())
+                continue;
+
+            bool isLast = token.back() == ';';
+            if (isLast)
+                token.pop_back();
+
+            if (opcode.empty())
+                opcode = token;
+            else if (opcode == "bm")
+                position.bestMoves.push_back(token);
+            else if (opcode == "am")
+                position.avoidMoves.push_back(token);
+            else if (opcode == "id")
+            {
+                token.erase(std::remove(token.begin(), token.end(), '"'), token.end());
+                position.id += (position.id.empty() ? "" : " ") + token;
+            }
+
+            if (isLast)
+                opcode = "";
+        }
+
+        return position;
+    }
+
+    std::vector<Position> load(const std::string& filename)
+    {
+        std::vector<Position> positions;
+        std::ifstream file(filename);
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+
+            positions.push_back(parse(line));
+            if (positions.back().id.empty())
+                positions.back().id = std::to_string(positions.size());
+        }
+
+        return positions;
+    }
+
+    // Search a test position, and check the best move against its solutions
+    static Result solve(const Position& position, const SearchLimits& limits,
+                        const SearchOptions& options, TT::Table* table)
+    {
+        Result result;
+        result.id = position.id;
+
+        Board board(position.fen);
+        Search search(&board, options, table);
+        search.setOutput(nullptr);
+        search.think(limits);
+
+        Move best = search.bestMove;
+        result.move = Notation::toSAN(board, best);
+        result.solved = !position.bestMoves.empty() || !position.avoidMoves.empty();
+
+        if (!position.bestMoves.empty())
+        {
+            bool isBestMove = false;
+            for (auto& san : position.bestMoves)
+                isBestMove |= Notation::fromSAN(board, san) == best;
+            result.solved &= isBestMove;
+        }
+
+        for (auto& san : position.avoidMoves)
+            result.solved &= !(Notation::fromSAN(board, san) == best);
+
+        result.time = search.bestMoveTime;
+        result.solutionNodes = search.bestMoveNodes;
+        result.nodes = search.getNodes();
+
+        return result;
+    }
+
+    std::vector<Result> run(const std::vector<Position>& positions, const SearchLimits& limits,
+                            const SearchOptions& options, unsigned nThreads, size_t hashBytes,
+                            std::ostream& os)
+    {
+        std::vector<Result> results(positions.size());
+        std::atomic<unsigned> next(0);
+        std::mutex outputMutex;
+        auto start = high_resolution_clock::now();
+
+        // Each worker takes the next unsolved position, searching it with
+        // its own board, search and transposition table
+        auto worker = [&]()
+        {
+            TT::Table table(hashBytes);
+
+            for (unsigned i = next++; i < positions.size(); i = next++)
+            {
+                table.clear();
+                results[i] = solve(positions[i], limits, options, &table);
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                os << "info string epd " << results[i].id
+                   << (results[i].solved ? " solved" : " failed")
+                   << " bestmove " << results[i].move
+                   << " time " << results[i].time
+                   << " solution-nodes " << results[i].solutionNodes
+                   << " nodes " << results[i].nodes << std::endl;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        nThreads = std::max(1u, nThreads);
+        for (unsigned i = 0; i < nThreads; i++)
+            workers.emplace_back(worker);
+        for (auto& thread : workers)
+            thread.join();
+
+        // Summarize the solve rate, time to solution and speed
+        duration<double> d = duration_cast<duration<double>>(high_resolution_clock::now() - start);
+        unsigned nSolved = 0;
+        U64 totalTime = 0,
+            totalNodes = 0;
+        for (auto& result : results)
+        {
+            totalNodes += result.nodes;
+            if (result.solved)
+            {
+                nSolved++;
+                totalTime += (U64)result.time;
+            }
+        }
+
+        os << "info string epd solved " << nSolved << "/" << results.size()
+           << " (" << (results.empty() ? 0 : 100.0 * nSolved / results.size()) << "%)"
+           << " time-to-solution " << (nSolved ? totalTime / nSolved : 0) << " ms"
+           << " nodes " << totalNodes
+           << " nps " << (U64)(totalNodes / d.count())
+           << " threads " << nThreads << std::endl;
+
+        return results;
+    }
+
+}
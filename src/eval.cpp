@@ -1,13 +1,27 @@
 #include <iomanip>
 #include "eval.hpp"
+#include "evalparams.hpp"
 #include "board.hpp"
 #include "types.hpp"
+#include "endgame.hpp"
+#include "material.hpp"
 
 template<bool debug>
-int Board::eval() const
+int Board::eval(int alpha, int beta) const
 {
+    // Recognized endgames are scored by their own evaluators
+    const Material::Entry& material = Material::probe(*this);
+    if (material.evaluator)
+    {
+        int knownScore = material.evaluate(*this);
+        if (debug)
+            std::cout << " Endgame    |      -      |      -      | "
+                      << std::setw(6) << knownScore << std::endl;
+        return knownScore;
+    }
+
     // Taper the eval between opening and endgame values
-    int opPhase = calculatePhase();
+    int opPhase = material.phase;
     int egPhase = (TOTALPHASE - opPhase);
     double openingModifier = opPhase / static_cast<double>(TOTALPHASE);
 
@@ -85,26 +99,32 @@ int Board::eval() const
                               + egPhase * Eval::HalfOpenFileBonus[ENDGAME]) / TOTALPHASE;
     double halfOpenFileScore = ((wSliders & wHalfOpenFiles).count() - (bSliders & bHalfOpenFiles).count()) * halfOpenFileValue;
 
-    // As pawns are captured, penalize knights and give bonus to rooks
-    int capturedPawns = 16 - allPawns.count();
-    int knightPen = (count<KNIGHT>(WHITE) - count<KNIGHT>(BLACK))
-                  * (capturedPawns * Eval::KNIGHT_PENALTY_PER_PAWN);
-    int rookBonus = (count<ROOK>(WHITE) - count<ROOK>(BLACK))
-                  * (capturedPawns * Eval::ROOK_BONUS_PER_PAWN);
-
     /**
      *  Evaluate individual pieces
      */
     Square wking = getKingSq(WHITE),
            bking = getKingSq(BLACK);
-    BB occ = occupancy();
-    BB pieces;
+    BB occ = occupancy(),
+       wTargets = ~getPieces<ALL>(WHITE),
+       bTargets = ~getPieces<ALL>(BLACK);
+    BB pieces, moves;
+
+    // Each piece's attacks are looked up once, as it is visited below
+    Eval::Attacks attacks;
+    attacks.kingZone[WHITE] = BB(G::KING_ATTACKS[wking]) | wking;
+    attacks.kingZone[BLACK] = BB(G::KING_ATTACKS[bking]) | bking;
+    attacks.add(WHITE, PAWN, MoveGen::movesByPawns<PawnMove::LEFT,  WHITE>(wPawns));
+    attacks.add(WHITE, PAWN, MoveGen::movesByPawns<PawnMove::RIGHT, WHITE>(wPawns));
+    attacks.add(BLACK, PAWN, MoveGen::movesByPawns<PawnMove::LEFT,  BLACK>(bPawns));
+    attacks.add(BLACK, PAWN, MoveGen::movesByPawns<PawnMove::RIGHT, BLACK>(bPawns));
+    attacks.add(WHITE, KING, G::KING_ATTACKS[wking]);
+    attacks.add(BLACK, KING, G::KING_ATTACKS[bking]);
 
     // Determine outposts
     BB wHoles = ~wPawns.getFrontAttackSpan<WHITE>() & G::WHITEHOLES,
        bHoles = ~bPawns.getFrontAttackSpan<BLACK>() & G::BLACKHOLES,
-       wOutposts = bHoles & MoveGen::attacksByPawns<WHITE>(wPawns),
-       bOutposts = wHoles & MoveGen::attacksByPawns<BLACK>(bPawns),
+       wOutposts = bHoles & attacks.byType[WHITE][PAWN],
+       bOutposts = wHoles & attacks.byType[BLACK][PAWN],
        allOutposts = wOutposts | bOutposts;
 
     // Knights
@@ -117,8 +137,9 @@ int Board::eval() const
         wKnightScore += Eval::KNIGHT_TROPISM[G::DISTANCE[bking][sq]];
         if (Types::getRank(sq) == RANK1)
             wKnightScore += Eval::BACK_RANK_MINOR_PENALTY * openingModifier;
-        BB validOutposts = MoveGen::movesByPiece<KNIGHT>(sq, occ) | sq;
-        if (validOutposts & allOutposts)
+        moves = MoveGen::movesByPiece<KNIGHT>(sq, occ);
+        attacks.add(WHITE, KNIGHT, moves, wTargets);
+        if ((moves | sq) & allOutposts)
             wKnightScore += Eval::MINOR_OUTPOST_BONUS;
     }
     double bKnightScore = 0;
@@ -130,8 +151,9 @@ int Board::eval() const
         bKnightScore += Eval::KNIGHT_TROPISM[G::DISTANCE[wking][sq]];
         if (Types::getRank(sq) == RANK8)
             bKnightScore += Eval::BACK_RANK_MINOR_PENALTY * openingModifier;
-        BB validOutposts = MoveGen::movesByPiece<KNIGHT>(sq, occ) | sq;
-        if (validOutposts & allOutposts)
+        moves = MoveGen::movesByPiece<KNIGHT>(sq, occ);
+        attacks.add(BLACK, KNIGHT, moves, bTargets);
+        if ((moves | sq) & allOutposts)
             bKnightScore += Eval::MINOR_OUTPOST_BONUS;
     }
     if (debug)
@@ -145,9 +167,6 @@ int Board::eval() const
     // Bishops
     double wBishopScore = 0;
     pieces = getPieces<BISHOP>(WHITE);
-    if ((pieces & G::WHITESQUARES) && (pieces & G::BLACKSQUARES))
-        wBishopScore += (opPhase * Eval::BishopPairBonus[OPENING]
-                      + (egPhase * Eval::BishopPairBonus[ENDGAME])) / TOTALPHASE;
     while (pieces)
     {
         Square sq = pieces.advanced<WHITE>();
@@ -155,15 +174,13 @@ int Board::eval() const
         wBishopScore += Eval::BISHOP_TROPISM[G::DISTANCE[bking][sq]];
         if (Types::getRank(sq) == RANK1)
             wBishopScore += Eval::BACK_RANK_MINOR_PENALTY * openingModifier;
-        BB validOutposts = MoveGen::movesByPiece<BISHOP>(sq, occ) | sq;
-        if (validOutposts & allOutposts)
+        moves = MoveGen::movesByPiece<BISHOP>(sq, occ);
+        attacks.add(WHITE, BISHOP, moves, wTargets);
+        if ((moves | sq) & allOutposts)
             wBishopScore += Eval::MINOR_OUTPOST_BONUS;
     }
     double bBishopScore = 0;
     pieces = getPieces<BISHOP>(BLACK);
-    if ((pieces & G::WHITESQUARES) && (pieces & G::BLACKSQUARES))
-        bBishopScore += (opPhase * Eval::BishopPairBonus[OPENING]
-                      + (egPhase * Eval::BishopPairBonus[ENDGAME])) / TOTALPHASE;
     while (pieces)
     {
         Square sq = pieces.advanced<BLACK>();
@@ -171,8 +188,9 @@ int Board::eval() const
         bBishopScore += Eval::BISHOP_TROPISM[G::DISTANCE[wking][sq]];
         if (Types::getRank(sq) == RANK8)
             bBishopScore += Eval::BACK_RANK_MINOR_PENALTY * openingModifier;
-        BB validOutposts = MoveGen::movesByPiece<BISHOP>(sq, occ) | sq;
-        if (validOutposts & allOutposts)
+        moves = MoveGen::movesByPiece<BISHOP>(sq, occ);
+        attacks.add(BLACK, BISHOP, moves, bTargets);
+        if ((moves | sq) & allOutposts)
             bBishopScore += Eval::MINOR_OUTPOST_BONUS;
     }
     if (debug)
@@ -194,7 +212,9 @@ int Board::eval() const
         wRookScore += Eval::ROOK_TROPISM[G::DISTANCE[wking][sq]] * openingModifier;
         if (Types::getRank(sq) >= RANK7)
             wRookScore += Eval::ROOK_ON_SEVENTH_BONUS * openingModifier;
-        if (MoveGen::movesByPiece<ROOK>(sq, occ) & pieces)
+        moves = MoveGen::movesByPiece<ROOK>(sq, occ);
+        attacks.add(WHITE, ROOK, moves, wTargets);
+        if (moves & pieces)
             wRookScore += Eval::CONNECTED_ROOK_BONUS;
     }
     double bRookScore = 0;
@@ -207,7 +227,9 @@ int Board::eval() const
         bRookScore += Eval::ROOK_TROPISM[G::DISTANCE[bking][sq]] * openingModifier;
         if (Types::getRank(sq) <= RANK2)
             bRookScore += Eval::ROOK_ON_SEVENTH_BONUS * openingModifier;
-        if (MoveGen::movesByPiece<ROOK>(sq, occ) & pieces)
+        moves = MoveGen::movesByPiece<ROOK>(sq, occ);
+        attacks.add(BLACK, ROOK, moves, bTargets);
+        if (moves & pieces)
             bRookScore += Eval::CONNECTED_ROOK_BONUS;
     }
     if (debug)
@@ -227,6 +249,7 @@ int Board::eval() const
         pieces.clear(sq);
         wQueenScore += Eval::QUEEN_TROPISM[G::DISTANCE[bking][sq]];
         wQueenScore += Eval::QUEEN_TROPISM[G::DISTANCE[wking][sq]] * openingModifier;
+        attacks.add(WHITE, QUEEN, MoveGen::movesByPiece<QUEEN>(sq, occ), wTargets);
     }
     double bQueenScore = 0;
     pieces = getPieces<QUEEN>(BLACK);
@@ -236,6 +259,7 @@ int Board::eval() const
         pieces.clear(sq);
         bQueenScore += Eval::QUEEN_TROPISM[G::DISTANCE[wking][sq]];
         bQueenScore += Eval::QUEEN_TROPISM[G::DISTANCE[bking][sq]] * openingModifier;
+        attacks.add(BLACK, QUEEN, MoveGen::movesByPiece<QUEEN>(sq, occ), bTargets);
     }
     if (debug)
 	{
@@ -249,13 +273,13 @@ int Board::eval() const
                       + (wBishopScore - bBishopScore)
                       + (wRookScore - bRookScore)
                       + (wQueenScore - bQueenScore)
-                      + openFileScore + halfOpenFileScore + knightPen + rookBonus;
+                      + openFileScore + halfOpenFileScore + material.imbalance;
     if (debug)
 	{
 		std::cout << " Open files |      -      |      -      | "
                   << std::setw(6) << openFileScore + halfOpenFileScore << std::endl
-                  << " Pawns adj. |      -      |      -      | "
-                  << std::setw(6) << knightPen + rookBonus << std::endl;
+                  << " Imbalance  |      -      |      -      | "
+                  << std::setw(6) << material.imbalance << std::endl;
 	}
 
     // Kings
@@ -267,25 +291,46 @@ int Board::eval() const
        bShieldWeak = bShield.shift_so() & bPawns;
     double rawKingScore = Eval::STRONG_KING_SHIELD_BONUS * (wShieldStrong.count() - bShieldStrong.count())
                         + Eval::WEAK_KING_SHIELD_BONUS * (wShieldWeak.count() - bShieldWeak.count());
-    double kingScore = rawKingScore * std::min(16, (int)fullMoveCounter) / 16 * openingModifier;
+    double shieldScore = rawKingScore * (int)std::min(Eval::KING_SAFETY_MOVES, fullMoveCounter) / (int)Eval::KING_SAFETY_MOVES * openingModifier;
+
+    // Attacks on the kings, counted in units and scaled by a danger table
+    double attackScore = (calculateKingDanger(BLACK, attacks) - calculateKingDanger(WHITE, attacks))
+                       * Eval::KING_ATTACK_SCALE / 100.0 * openingModifier;
+    double kingScore = shieldScore + attackScore;
     if (debug)
 	{
 		std::cout << " King Safety| "
-                  << std::setw(6) << kingScore
+                  << std::setw(6) << shieldScore
                   << "      |      -      | "
-                  << std::setw(6) << kingScore << std::endl;
+                  << std::setw(6) << shieldScore << std::endl
+                  << " King Attack| "
+                  << std::setw(6) << attackScore
+                  << "      |      -      | "
+                  << std::setw(6) << attackScore << std::endl;
 	}
 
-    double mobilityScore = calculateMobilityScore(opPhase, egPhase) / TOTALPHASE;
     int color = 2*stm - 1; // +1 when stm=WHITE, -1 when wtm=BLACK
+
+    // Leave mobility out when the rest of the score is already outside
+    // the caller's window, as callers' margins expect
+    double scale = material.scale(*this) / (double)Endgame::SCALE_NORMAL;
+    double partialScore = color * (materialScore + positionScore + pawnScore +
+                                   pieceScore + kingScore) * scale + Eval::TEMPO_BONUS;
+    if (!debug && (partialScore <= alpha || partialScore >= beta))
+        return partialScore;
+
+    double mobilityScore = calculateMobilityScore(attacks, opPhase, egPhase) / TOTALPHASE;
     double score = color * (materialScore + positionScore + pawnScore +
-                         pieceScore + kingScore + mobilityScore);
+                         pieceScore + kingScore + mobilityScore) * scale;
 
     if (debug)
 	{
 		std::cout << " Mobility   |      -      |      -      | "
-                  << std::setw(6) << mobilityScore << std::endl
-                  << "------------+-------------+-------------+----------" << std::endl
+                  << std::setw(6) << mobilityScore << std::endl;
+        if (scale != 1)
+            std::cout << " Scale      |      -      |      -      | "
+                      << std::setw(6) << scale << std::endl;
+        std::cout << "------------+-------------+-------------+----------" << std::endl
                   << " Sub Total  |      -      |      -      | "
                   << std::setw(6) << score << std::endl
                   << " Tempo      |      -      |      -      | "
@@ -297,212 +342,60 @@ int Board::eval() const
     return score + Eval::TEMPO_BONUS;
 }
 
-// Instantiate eval functions
-template int Board::eval<true>() const;
-template int Board::eval<false>() const;
-
-namespace Eval
+// Material and piece square values only, which are kept incrementally,
+// for when the rest of the eval cannot change a decision
+int Board::lazyEval() const
 {
+    const Material::Entry& material = Material::probe(*this);
+    if (material.evaluator)
+        return material.evaluate(*this);
 
-    const int MobilityScaling[2][6] = {
-        { 0,6,2,0,0,0 },
-        { 2,3,1,1,1,1 }
-    };
+    int opPhase = material.phase;
+    int egPhase = (TOTALPHASE - opPhase);
+    double positionScore = (openingScore * opPhase + endgameScore * egPhase) / (double)TOTALPHASE;
 
-    const int PassedPawnBonus[2]    = {  30,  200 };
-    const int DoublePawnPenalty[2]  = { -30, -100 };
-    const int TriplePawnPenalty[2]  = { -45, -100 };
-    const int IsoPawnPenalty[2]     = { -30,  -40 };
-    const int OpenFileBonus[2]      = {  20,   10 };
-    const int HalfOpenFileBonus[2]  = {  10,    0 };
-    const int BishopPairBonus[2]    = {  20,   60 };
-
-    const int TEMPO_BONUS                 = 25;
-    const int KNIGHT_PENALTY_PER_PAWN     = -2;
-    const int ROOK_BONUS_PER_PAWN         = 2;
-    const int CONNECTED_ROOK_BONUS        = 15;
-    const int ROOK_ON_SEVENTH_BONUS       = 20;
-    const int BACK_RANK_MINOR_PENALTY     = -6;
-    const int MINOR_OUTPOST_BONUS         = 10;
-    const int STRONG_KING_SHIELD_BONUS    = 10;
-    const int WEAK_KING_SHIELD_BONUS      = 5;
-
-    const int PieceValues[6][2] = {
-        { -PAWNSCORE,   PAWNSCORE },
-        { -KNIGHTSCORE, KNIGHTSCORE },
-        { -BISHOPSCORE, BISHOPSCORE },
-        { -ROOKSCORE,   ROOKSCORE },
-        { -QUEENSCORE,  QUEENSCORE },
-        { -KINGSCORE,   KINGSCORE }
-    };
+    int color = 2*stm - 1;
+    double score = color * (materialScore + positionScore);
+    return score + Eval::TEMPO_BONUS;
+}
 
-    const int KNIGHT_TROPISM[8] = {
-        0, 5, 4, 2, 0, 0, -1, -3
-    };
+// Instantiate eval functions
+template int Board::eval<true>(int, int) const;
+template int Board::eval<false>(int, int) const;
 
-    const int BISHOP_TROPISM[8] = {
-        0, 5, 4, 3, 2, 1, 0, 0
+namespace Eval
+{
+
+    // Attack units per square of the king zone attacked, by piece type
+    const int KingAttackWeight[7] = {
+        0, 0, 2, 2, 3, 5, 0
     };
 
-    const int ROOK_TROPISM[8] = {
-        0, 6, 5, 3, 2, 1, 0, 0
+    // Attack units for a check that lands on a square the king's side
+    // does not cover, by piece type
+    const int SafeCheckUnits[7] = {
+        0, 0, 4, 2, 4, 6, 0
     };
 
-    const int QUEEN_TROPISM[8] = {
-        0, 12, 10, 6, 4, 2, 0, -2
+    // Centipawns of danger by attack units, rising slowly for lone attacks
+    // and steeply once several pieces join in
+    const int KingDanger[100] = {
+          0,   0,   1,   2,   3,   5,   7,   9,  12,  15,
+         18,  22,  26,  30,  35,  39,  44,  50,  56,  62,
+         68,  75,  82,  85,  89,  97, 105, 113, 122, 131,
+        140, 150, 169, 180, 191, 202, 213, 225, 237, 248,
+        260, 272, 283, 295, 307, 319, 330, 342, 354, 366,
+        377, 389, 401, 412, 424, 436, 448, 459, 471, 483,
+        494, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+        500, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+        500, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+        500, 500, 500, 500, 500, 500, 500, 500, 500, 500
     };
 
     const int QUEEN_EARLY_DEV_PENALTY[4] = {
         0, -2, -8, -24
     };
 
-    const int PieceSqValues[6][2][64] =
-    {
-        { // Pawn piece square values
-            {
-                0,  0,  0,  0,  0,  0,  0,  0,
-                50, 50, 50, 50, 50, 50, 50, 50,
-                10, 10, 20, 30, 30, 20, 10, 10,
-                5,  5, 10, 25, 25, 10,  5,  5,
-                0,  0,  0, 20, 20,  0,  0,  0,
-                5, -5,-10,  0,  0,-10, -5,  5,
-                5, 10, 10,-20,-20, 10, 10,  5,
-                0,  0,  0,  0,  0,  0,  0,  0
-            }, // Opening
-
-            {
-                 0,  0,  0,  0,  0,  0,  0,  0,
-               115,125,125,125,125,125,125,125,
-                85, 95, 95,105,105, 95, 95, 85,
-                75, 85, 90,100,100, 90, 85, 65,
-                65, 80, 80, 95, 95, 80, 80, 65,
-                55, 75, 75, 75, 75, 75, 75, 55,
-                50, 70, 70, 70, 70, 70, 70, 50,
-                 0,  0,  0,  0,  0,  0,  0,  0
-            } // End game
-        },
-
-        { // Knight piece square values 
-            {
-                -50,-40,-30,-30,-30,-30,-40,-50,
-                -40,-20,  0,  0,  0,  0,-20,-40,
-                -30,  0, 10, 15, 15, 10,  0,-30,
-                -30,  5, 15, 20, 20, 15,  5,-30,
-                -30,  0, 15, 20, 20, 15,  0,-30,
-                -30,  5, 10, 15, 15, 10,  5,-30,
-                -40,-20,  0,  5,  5,  0,-20,-40,
-                -50,-40,-30,-30,-30,-30,-40,-50,
-            }, // Opening
-
-            {
-                -50,-40,-30,-30,-30,-30,-40,-50,
-                -40,-20,  0,  0,  0,  0,-20,-40,
-                -30,  0, 10, 15, 15, 10,  0,-30,
-                -30,  5, 15, 20, 20, 15,  5,-30,
-                -30,  0, 15, 20, 20, 15,  0,-30,
-                -30,  5, 10, 15, 15, 10,  5,-30,
-                -40,-20,  0,  5,  5,  0,-20,-40,
-                -50,-40,-30,-30,-30,-30,-40,-50,
-            }  // End game
-        },
-
-        { // Bishop piece square values
-            {
-                -20,-10,-10,-10,-10,-10,-10,-20,
-                -10,  0,  0,  0,  0,  0,  0,-10,
-                -10,  0,  5, 10, 10,  5,  0,-10,
-                -10,  5,  5, 10, 10,  5,  5,-10,
-                -10,  0, 10, 10, 10, 10,  0,-10,
-                -10, 10, 10, 10, 10, 10, 10,-10,
-                -10, 10,  0,  0,  0,  0, 10,-10,
-                -20,-10,-10,-10,-10,-10,-10,-20
-            }, // Opening
-
-            {
-                -20,-10,-10,-10,-10,-10,-10,-20,
-                -10,  0,  0,  0,  0,  0,  0,-10,
-                -10,  0,  5, 10, 10,  5,  0,-10,
-                -10,  5,  5, 10, 10,  5,  5,-10,
-                -10,  0, 10, 10, 10, 10,  0,-10,
-                -10, 10, 10, 10, 10, 10, 10,-10,
-                -10,  5,  0,  0,  0,  0,  5,-10,
-                -20,-10,-10,-10,-10,-10,-10,-20
-            }  // End game
-        },
-
-        { // Rook piece square values
-            {
-                  0,  0,  0,  0,  0,  0,  0,  0,
-                  5, 10, 10, 10, 10, 10, 10,  5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                  0,  0,  0,  5,  5,  0,  0,  0
-            }, // Opening
-
-            {
-                  0,  0,  0,  0,  0,  0,  0,  0,
-                  5, 10, 10, 10, 10, 10, 10,  5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                 -5,  0,  0,  0,  0,  0,  0, -5,
-                  0,  0,  0,  5,  5,  0,  0,  0
-            }  // End game
-        },
-
-        { // Queen piece square values 
-            {
-                -20,-10,-10, -5, -5,-10,-10,-20,
-                -10,  0,  0,  0,  0,  0,  0,-10,
-                -10,  0,  5,  5,  5,  5,  0,-10,
-                 -5,  0,  5,  5,  5,  5,  0, -5,
-                  0,  0,  5,  5,  5,  5,  0, -5,
-                -10,  5,  5,  5,  5,  5,  0,-10,
-                -10,  0,  5,  0,  0,  0,  0,-10,
-                -20,-10,-10, -5, -5,-10,-10,-20
-            }, // Opening
-
-            {
-                -20,-10,-10, -5, -5,-10,-10,-20,
-                -10,  0,  0,  0,  0,  0,  0,-10,
-                -10,  0,  5,  5,  5,  5,  0,-10,
-                 -5,  0,  5,  5,  5,  5,  0, -5,
-                  0,  0,  5,  5,  5,  5,  0, -5,
-                -10,  5,  5,  5,  5,  5,  0,-10,
-                -10,  0,  5,  0,  0,  0,  0,-10,
-                -20,-10,-10, -5, -5,-10,-10,-20
-            }  // End game
-        },
-
-        { // King piece square values 
-            {
-                 30,-40,-40,-50,-50,-40,-40,-30,
-                -30,-40,-40,-50,-50,-40,-40,-30,
-                -30,-40,-40,-50,-50,-40,-40,-30,
-                -30,-40,-40,-50,-50,-40,-40,-30,
-                -20,-30,-30,-40,-40,-30,-30,-20,
-                -10,-20,-20,-20,-20,-20,-20,-10,
-                 20, 20,  0,  0,  0,  0, 20, 20,
-                 20, 30, 10,  0,  0, 10, 30, 20
-            }, // Opening 
-
-            {
-                -50,-40,-30,-20,-20,-30,-40,-50,
-                -30,-20,-10,  0,  0,-10,-20,-30,
-                -30,-10, 20, 30, 30, 20,-10,-30,
-                -30,-10, 30, 40, 40, 30,-10,-30,
-                -30,-10, 30, 40, 40, 30,-10,-30,
-                -30,-10, 20, 30, 30, 20,-10,-30,
-                -30,-30,  0,  0,  0,  0,-30,-30,
-                -50,-30,-30,-30,-30,-30,-30,-50
-            }  // End game
-        }
-    };
-
     const Square ColorSq[2][64] = {
         {
             A1, B1, C1, D1, E1, F1, G1, H1,
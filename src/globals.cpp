@@ -5,6 +5,8 @@
 #include "types.hpp"
 #include "magics.hpp"
 #include "zobrist.hpp"
+#include "search.hpp"
+#include "endgame.hpp"
 
 namespace G
 {
@@ -66,9 +68,10 @@ namespace G
 
 void G::init()
 {
-    // Initialize magics and Zobrist keys
+    // Initialize magics, Zobrist keys and search tables
     Magic::init();
     Zobrist::init();
+    Search::init();
 
     // Initialize bit set and clear masks
     for (Square sq = A1; sq != INVALID; sq++)
@@ -197,6 +200,9 @@ void G::init()
             }
         }
     }
+
+    // The endgame bitbase is generated from the masks above
+    Endgame::init();
 }
 
 VecStr G::split(const std::string &s, char delim)
@@ -1,11 +1,34 @@
 #include <iostream>
 #include "globals.hpp"
 #include "uci.hpp"
+#include "analysis.hpp"
+#include "pgn.hpp"
+#include "bookbuilder.hpp"
+#include "match.hpp"
+#include "tuner.hpp"
+#include "datagen.hpp"
+#include "tablebase.hpp"
 
-int main()
+int main(int argc, char* argv[])
 {
 	G::init();
 
+	VecStr args(argv + 1, argv + argc);
+	if (!args.empty() && args.at(0) == "analyse")
+		return Analysis::main(args);
+	if (!args.empty() && args.at(0) == "pgn")
+		return PGN::main(args);
+	if (!args.empty() && args.at(0) == "book")
+		return BookBuilder::main(args);
+	if (!args.empty() && args.at(0) == "match")
+		return Match::main(args);
+	if (!args.empty() && args.at(0) == "tune")
+		return Tuner::main(args);
+	if (!args.empty() && args.at(0) == "datagen")
+		return DataGen::main(args);
+	if (!args.empty() && args.at(0) == "tablebase")
+		return Tablebase::main(args);
+
 	UCI::Controller controller(std::cin, std::cout);
 	controller.loop();
 
@@ -0,0 +1,605 @@
+#include "match.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "board.hpp"
+#include "movegen.hpp"
+#include "notation.hpp"
+#include "epd.hpp"
+#include "tablebase.hpp"
+
+namespace Match {
+
+    static const double SPRT_PRIOR = 0.5;
+
+    static double expectedScore(double elo)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    double SPRT::llr(U64 wins, U64 draws, U64 losses) const
+    {
+        double n = (double)(wins + draws + losses);
+        if (n == 0)
+            return 0;
+
+        // Mean and variance of the per-game score over the trinomial
+        // frequencies, with half a game added to each outcome so that a
+        // one-sided result still has a variance
+        double total = n + 3 * SPRT_PRIOR,
+               w = (wins + SPRT_PRIOR) / total,
+               d = (draws + SPRT_PRIOR) / total,
+               s = w + d / 2,
+               var = w + d / 4 - s * s;
+
+        double s0 = expectedScore(elo0),
+               s1 = expectedScore(elo1);
+
+        return 0.5 * n * (s1 - s0) * (2 * s - s0 - s1) / var;
+    }
+
+    double SPRT::lowerBound() const
+    {
+        return std::log(beta / (1 - alpha));
+    }
+
+    double SPRT::upperBound() const
+    {
+        return std::log((1 - beta) / alpha);
+    }
+
+    int SPRT::status(U64 wins, U64 draws, U64 losses) const
+    {
+        double ratio = llr(wins, draws, losses);
+        if (ratio >= upperBound())
+            return 1;
+        if (ratio <= lowerBound())
+            return -1;
+        return 0;
+    }
+
+    double elo(U64 wins, U64 draws, U64 losses)
+    {
+        double n = (double)(wins + draws + losses);
+        if (n == 0)
+            return 0;
+
+        double s = std::min(std::max((wins + draws / 2.0) / n, 1e-6), 1 - 1e-6);
+        return -400.0 * std::log10(1.0 / s - 1.0);
+    }
+
+    // Parse a whole number, returning false unless all of the text is one
+    static bool parseInt(const std::string& text, int& n)
+    {
+        size_t end = 0;
+        try
+        {
+            n = std::stoi(text, &end);
+        }
+        catch (const std::logic_error&)
+        {
+            return false;
+        }
+
+        return end == text.size();
+    }
+
+    // Check an option against its range, as an error message
+    static std::string checkOption(const std::pair<std::string, std::string>& option, int min, int max)
+    {
+        int n = 0;
+        if (!parseInt(option.second, n) || n < min || n > max)
+            return "invalid value " + option.second + " for option " + option.first
+                 + ", expected " + std::to_string(min) + " to " + std::to_string(max);
+        return "";
+    }
+
+    Player::Player(const EngineConfig& config, const SearchLimits& searchLimits, size_t hashBytes)
+        : limits(searchLimits)
+        , table(config.command.empty() ? hashBytes : 1024)
+        , search(nullptr, SearchOptions(), &table)
+    {
+        search.setOutput(nullptr);
+        if (!config.command.empty())
+        {
+            start(config);
+            return;
+        }
+
+        // Reject unknown options and values out of range, rather than play
+        // a match between engines that are unknowingly the same
+        for (auto& option : config.options)
+        {
+            int min = 0,
+                max = 0;
+            if (!SearchOptions::range(option.first, min, max))
+                error = "unknown option " + option.first;
+            else
+                error = checkOption(option, min, max);
+            if (!error.empty())
+                return;
+
+            search.options.set(option.first, std::stoi(option.second));
+        }
+    }
+
+    // Start an external engine and check its options against those it
+    // lists, leaving the reason in the error if it cannot be used
+    void Player::start(const EngineConfig& config)
+    {
+        // Writes to an engine that has exited fail rather than raise a signal
+        signal(SIGPIPE, SIG_IGN);
+
+        // Start the external engine with its stdin and stdout on pipes
+        int toEngine[2],
+            fromEngine[2];
+        if (pipe(toEngine))
+        {
+            error = std::string("cannot create a pipe: ") + std::strerror(errno);
+            return;
+        }
+        if (pipe(fromEngine))
+        {
+            error = std::string("cannot create a pipe: ") + std::strerror(errno);
+            close(toEngine[0]);
+            close(toEngine[1]);
+            return;
+        }
+
+        pid = fork();
+        if (pid < 0)
+        {
+            error = std::string("cannot fork: ") + std::strerror(errno);
+            for (int fd : { toEngine[0], toEngine[1], fromEngine[0], fromEngine[1] })
+                close(fd);
+            return;
+        }
+        if (pid == 0)
+        {
+            dup2(toEngine[0], STDIN_FILENO);
+            dup2(fromEngine[1], STDOUT_FILENO);
+            close(toEngine[1]);
+            close(fromEngine[0]);
+            execl("/bin/sh", "sh", "-c", config.command.c_str(), (char*)nullptr);
+            _exit(EXIT_FAILURE);
+        }
+
+        close(toEngine[0]);
+        close(fromEngine[1]);
+        out = fdopen(toEngine[1], "w");
+        in = fdopen(fromEngine[0], "r");
+
+        VecStr lines;
+        send("uci");
+        if (readUntil("uciok", &lines).empty())
+        {
+            error = "cannot start " + config.command + ": no uciok";
+            return;
+        }
+
+        // "option name <id> type spin default <x> min <a> max <b>"
+        for (auto& option : config.options)
+        {
+            std::string prefix = "option name " + option.first + " type ";
+            auto line = std::find_if(lines.begin(), lines.end(),
+                                     [&](const std::string& l) { return l.compare(0, prefix.size(), prefix) == 0; });
+            if (line == lines.end())
+            {
+                error = "unknown option " + option.first;
+                return;
+            }
+
+            auto tokens = G::split(line->substr(prefix.size()), ' ');
+            if (!tokens.empty() && tokens[0] == "spin")
+            {
+                int min = std::numeric_limits<int>::min(),
+                    max = std::numeric_limits<int>::max();
+                for (unsigned i = 0; i + 1 < tokens.size(); i++)
+                {
+                    if (tokens[i] == "min")
+                        parseInt(tokens[i+1], min);
+                    else if (tokens[i] == "max")
+                        parseInt(tokens[i+1], max);
+                }
+
+                error = checkOption(option, min, max);
+                if (!error.empty())
+                    return;
+            }
+
+            send("setoption name " + option.first + " value " + option.second);
+        }
+
+        send("isready");
+        if (readUntil("readyok").empty())
+            error = "cannot start " + config.command + ": no readyok";
+    }
+
+    Player::~Player()
+    {
+        if (pid <= 0)
+            return;
+
+        send("quit");
+        fclose(out);
+        fclose(in);
+        waitpid(pid, nullptr, 0);
+    }
+
+    void Player::send(const std::string& command)
+    {
+        fputs((command + "\n").c_str(), out);
+        fflush(out);
+    }
+
+    // Read lines up to one starting with the token, returning that line
+    // The last score reported before it is kept in the returned text, and
+    // the lines before it are kept if asked for
+    std::string Player::readUntil(const std::string& token, VecStr* lines)
+    {
+        char buffer[4096];
+        std::string score = "";
+
+        while (fgets(buffer, sizeof(buffer), in))
+        {
+            std::string line(buffer);
+            if (line.compare(0, token.size(), token) == 0)
+                return line + score;
+            if (lines)
+            {
+                line.erase(line.find_last_not_of(" \r\n") + 1);
+                lines->push_back(line);
+            }
+
+            size_t i = line.find(" score ");
+            if (i != std::string::npos)
+                score = line.substr(i);
+        }
+
+        return "";
+    }
+
+    void Player::newGame()
+    {
+        if (pid > 0)
+        {
+            send("ucinewgame");
+            send("isready");
+            readUntil("readyok");
+        }
+        else
+            table.clear();
+    }
+
+    Move Player::think(Board& board, int& score)
+    {
+        if (pid <= 0)
+        {
+            search.setBoard(&board);
+            search.think(limits);
+            score = search.bestScore;
+
+            return search.bestMove;
+        }
+
+        std::ostringstream go;
+        go << "go";
+        if (limits.depth)
+            go << " depth " << limits.depth;
+        if (limits.nodes)
+            go << " nodes " << limits.nodes;
+        if (limits.movetime)
+            go << " movetime " << limits.movetime;
+
+        send("position fen " + board.toFEN());
+        send(go.str());
+
+        // "bestmove <move> ... score cp <x>" or "score mate <n>"
+        auto tokens = G::split(readUntil("bestmove"), ' ');
+        score = 0;
+        for (unsigned i = 0; i + 1 < tokens.size(); i++)
+        {
+            if (tokens[i] == "cp")
+                score = std::stoi(tokens[i+1]);
+            else if (tokens[i] == "mate")
+            {
+                int n = std::stoi(tokens[i+1]);
+                score = n > 0 ? MATESCORE - 2 * n + 1 : -MATESCORE - 2 * n;
+            }
+        }
+
+        if (tokens.size() < 2)
+            return Move();
+
+        std::string move = tokens[1];
+        move.erase(move.find_last_not_of(" \r\n") + 1);
+        return Notation::fromUCI(board, move);
+    }
+
+    static bool hasLegalMove(Board& board)
+    {
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+
+        for (auto& move : gen.moves)
+            if (board.isLegalMove(move))
+                return true;
+
+        return false;
+    }
+
+    // Neither side can mate with at most a single minor piece left
+    static bool isInsufficientMaterial(const Board& board)
+    {
+        for (Color c : { WHITE, BLACK })
+            if (board.count<PAWN>(c) || board.count<ROOK>(c) || board.count<QUEEN>(c))
+                return false;
+
+        return board.getPieceCount(WHITE) + board.getPieceCount(BLACK) <= 1;
+    }
+
+    int playGame(Player& white, Player& black, const std::string& fen, const Options& options,
+                 const MoveCallback& onMove)
+    {
+        Board board(fen);
+        std::vector<U64> keys = { board.getKey() };
+        int winPlies = 0,
+            drawPlies = 0;
+
+        white.newGame();
+        black.newGame();
+
+        for (int ply = 0; ply < options.maxPlies; ply++)
+        {
+            Color stm = board.sideToMove();
+            int loss = stm == WHITE ? -1 : 1;
+
+            // Mate, stalemate, and draws by rule
+            if (!hasLegalMove(board))
+                return board.isCheck() ? loss : 0;
+            if (board.getHmClock() >= 100
+                || std::count(keys.begin(), keys.end(), board.getKey()) >= 3
+                || isInsufficientMaterial(board))
+                return 0;
+
+            // Positions in the tablebases are adjudicated by their result
+            int tbScore = 0;
+            if (Tablebase::probe(board, tbScore))
+                return tbScore > 0 ? -loss : tbScore < 0 ? loss : 0;
+
+            int score = 0;
+            Move move = (stm == WHITE ? white : black).think(board, score);
+            if (move.isNullMove())
+                return loss;
+            if (onMove)
+                onMove(board, move, score);
+
+            // Adjudicate a win once the score has stayed decisive for one
+            // side, or a draw once it has stayed level, for long enough
+            int whiteScore = stm == WHITE ? score : -score;
+            if (whiteScore >= options.winScore)
+                winPlies = std::max(winPlies, 0) + 1;
+            else if (whiteScore <= -options.winScore)
+                winPlies = std::min(winPlies, 0) - 1;
+            else
+                winPlies = 0;
+            if (std::abs(winPlies) >= options.winPlies)
+                return winPlies > 0 ? 1 : -1;
+
+            drawPlies = ply >= options.drawMinPly && std::abs(score) <= options.drawScore ? drawPlies + 1 : 0;
+            if (drawPlies >= options.drawPlies)
+                return 0;
+
+            board.make(move);
+            keys.push_back(board.getKey());
+        }
+
+        return 0;
+    }
+
+    // Get the starting position of a game pair, from the opening suite
+    // or as a seeded random walk from the start position
+    std::string opening(const std::vector<std::string>& openings, U64 pair, int randomPlies)
+    {
+        if (!openings.empty())
+            return openings[pair % openings.size()];
+
+        Board board(G::STARTFEN);
+        std::mt19937_64 rng(pair);
+
+        for (int i = 0; i < randomPlies; i++)
+        {
+            auto gen = MoveGen::Generator(&board);
+            gen.run();
+
+            std::vector<Move> legal;
+            for (auto& move : gen.moves)
+                if (board.isLegalMove(move))
+                    legal.push_back(move);
+            if (legal.empty())
+                break;
+
+            board.make(legal[rng() % legal.size()]);
+        }
+
+        return board.toFEN();
+    }
+
+    static EngineConfig parseEngine(const std::string& spec)
+    {
+        EngineConfig config;
+
+        for (auto& option : G::split(spec, ','))
+        {
+            size_t eq = option.find('=');
+            if (eq == std::string::npos)
+                continue;
+
+            if (option.substr(0, eq) == "cmd")
+                config.command = option.substr(eq + 1);
+            else
+                config.options.emplace_back(option.substr(0, eq), option.substr(eq + 1));
+        }
+
+        return config;
+    }
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--engine1")
+                options.engines[0] = parseEngine(value);
+            else if (flag == "--engine2")
+                options.engines[1] = parseEngine(value);
+            else if (flag == "--openings")
+                options.openings = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else if (flag == "--games")
+                options.games = std::stoull(value);
+            else if (flag == "--nodes")
+                options.limits.nodes = std::stoull(value);
+            else if (flag == "--depth")
+                options.limits.depth = std::stoi(value);
+            else if (flag == "--movetime")
+                options.limits.movetime = std::stoi(value);
+            else if (flag == "--hash")
+                options.hashBytes = (size_t)std::stoull(value) << 20;
+            else if (flag == "--tablebases")
+                options.tablebasePath = value;
+            else if (flag == "--elo0")
+                options.elo0 = std::stod(value);
+            else if (flag == "--elo1")
+                options.elo1 = std::stod(value);
+            else if (flag == "--alpha")
+                options.alpha = std::stod(value);
+            else if (flag == "--beta")
+                options.beta = std::stod(value);
+            else
+                continue;
+
+            i++;
+        }
+
+        // Default to fast fixed-node games
+        if (!options.limits.depth && !options.limits.nodes && !options.limits.movetime)
+            options.limits.nodes = 20000;
+
+        return options;
+    }
+
+    int main(const VecStr& args)
+    {
+        Options options = parseArgs(args);
+        SPRT sprt = { options.elo0, options.elo1, options.alpha, options.beta };
+
+        std::vector<std::string> openings;
+        if (!options.openings.empty())
+            for (auto& position : EPD::load(options.openings))
+                openings.push_back(position.fen);
+
+        if (!options.tablebasePath.empty())
+            std::cout << "tablebases " << Tablebase::load(options.tablebasePath) << std::endl;
+
+        // Start each engine once before any game, so that an engine that
+        // cannot be run or a bad option stops the match before it begins
+        for (auto& config : options.engines)
+        {
+            Player player(config, options.limits, 1 << 20);
+            if (!player.getError().empty())
+            {
+                std::cerr << player.getError() << std::endl;
+                return 1;
+            }
+        }
+
+        std::mutex resultMutex;
+        std::atomic<U64> next(0);
+        std::atomic<bool> stopped(false);
+        std::string error;
+        U64 wins = 0,
+            draws = 0,
+            losses = 0;
+
+        // Each thread plays one game at a time with its own pair of
+        // engines, each opening twice with colors reversed
+        auto worker = [&]()
+        {
+            Player first(options.engines[0], options.limits, options.hashBytes),
+                   second(options.engines[1], options.limits, options.hashBytes);
+
+            // Engines that fail to start stop every thread, for the caller
+            // to report once all have finished
+            for (auto* player : { &first, &second })
+            {
+                if (!player->getError().empty())
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    error = player->getError();
+                    stopped = true;
+                    return;
+                }
+            }
+
+            for (U64 i = next++; i < options.games && !stopped; i = next++)
+            {
+                std::string fen = opening(openings, i / 2, options.randomPlies);
+                int result = i % 2 == 0 ? playGame(first, second, fen, options)
+                                        : -playGame(second, first, fen, options);
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                wins += result > 0;
+                draws += result == 0;
+                losses += result < 0;
+
+                std::cout << "game " << wins + draws + losses
+                          << " wins " << wins << " losses " << losses << " draws " << draws
+                          << " elo " << elo(wins, draws, losses)
+                          << " llr " << sprt.llr(wins, draws, losses)
+                          << " (" << sprt.lowerBound() << ", " << sprt.upperBound() << ")" << std::endl;
+
+                if (sprt.status(wins, draws, losses) != 0)
+                    stopped = true;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < options.threads; i++)
+            workers.emplace_back(worker);
+        for (auto& thread : workers)
+            thread.join();
+
+        if (!error.empty())
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        int status = sprt.status(wins, draws, losses);
+        std::cout << "sprt " << (status > 0 ? "H1 accepted" : status < 0 ? "H0 accepted" : "inconclusive")
+                  << " elo " << elo(wins, draws, losses)
+                  << " games " << wins + draws + losses << std::endl;
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,70 @@
+#include "material.hpp"
+#include "board.hpp"
+#include "eval.hpp"
+#include "zobrist.hpp"
+
+namespace Material {
+
+    static thread_local Entry table[TABLE_SIZE];
+
+    // As pawns are captured, penalize knights and give bonus to rooks, and
+    // give the bishop pair a bonus
+    static double imbalance(const Board& board, int phase)
+    {
+        int capturedPawns = 16 - board.count<PAWN>();
+        int knightPen = (board.count<KNIGHT>(WHITE) - board.count<KNIGHT>(BLACK))
+                      * (capturedPawns * Eval::KNIGHT_PENALTY_PER_PAWN);
+        int rookBonus = (board.count<ROOK>(WHITE) - board.count<ROOK>(BLACK))
+                      * (capturedPawns * Eval::ROOK_BONUS_PER_PAWN);
+
+        double bishopPair = (phase * Eval::BishopPairBonus[OPENING]
+                          + (TOTALPHASE - phase) * Eval::BishopPairBonus[ENDGAME]) / (double)TOTALPHASE;
+        int pairs = (board.count<BISHOP>(WHITE) >= 2) - (board.count<BISHOP>(BLACK) >= 2);
+
+        return knightPen + rookBonus + pairs * bishopPair;
+    }
+
+    int Entry::evaluate(const Board& board) const
+    {
+        int score = evaluator(board, strong);
+        return board.sideToMove() == strong ? score : -score;
+    }
+
+    const Entry& probe(const Board& board)
+    {
+        U64 key = board.getMaterialKey();
+        Entry& entry = table[key & (TABLE_SIZE - 1)];
+        if (entry.key == key)
+            return entry;
+
+        entry.key = key;
+        entry.phase = board.calculatePhase();
+        entry.imbalance = imbalance(board, entry.phase);
+        entry.strong = WHITE;
+        if (!Endgame::find(key, entry.evaluator, entry.strong))
+            entry.evaluator = nullptr;
+        entry.scaler = Endgame::findScaler(board);
+
+        return entry;
+    }
+
+    U64 key(const std::string& code, Color strong)
+    {
+        static const std::string pieces = "PNBRQK";
+
+        int counts[NCOLORS][NPIECETYPES] = {};
+        U64 key = 0x0;
+        size_t weak = code.find('K', 1);
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            size_t pt = pieces.find(code[i]);
+            if (pt == std::string::npos)
+                continue;
+
+            Color c = i < weak ? strong : ~strong;
+            key ^= Zobrist::material[c][pt][counts[c][pt]++];
+        }
+        return key;
+    }
+
+}
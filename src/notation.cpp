@@ -0,0 +1,234 @@
+#include "notation.hpp"
+#include <cstring>
+#include "board.hpp"
+#include "movegen.hpp"
+
+namespace Notation {
+
+    static inline bool isFile(char c) { return c >= 'a' && c <= 'h'; }
+    static inline bool isRank(char c) { return c >= '1' && c <= '8'; }
+
+    static inline char fileChar(Square sq) { return static_cast<char>('a' + Types::getFile(sq)); }
+    static inline char rankChar(Square sq) { return static_cast<char>('1' + Types::getRank(sq)); }
+
+    // Get the piece type for an uppercase SAN letter, or NONE
+    static PieceType pieceType(char c)
+    {
+        for (PieceType pt = KNIGHT; pt <= KING; pt = PieceType(pt + 1))
+            if (Types::PieceChar[Types::makePiece(WHITE, pt)] == c)
+                return pt;
+
+        return NONE;
+    }
+
+    static bool hasLegalMove(Board& board)
+    {
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+
+        for (auto& move : gen.moves)
+            if (board.isLegalMove(move))
+                return true;
+
+        return false;
+    }
+
+    std::string toSAN(Board& board, Move move)
+    {
+        std::string san;
+        Square from = move.from(),
+               to = move.to();
+        PieceType piece = board.getPieceType(from);
+        bool isCapture = board.getPieceType(to) != NONE || move.type() == ENPASSANT;
+
+        if (move.type() == CASTLE)
+            san = to > from ? "O-O" : "O-O-O";
+
+        else if (piece == PAWN)
+        {
+            if (isCapture)
+                san += fileChar(from);
+        }
+        else
+        {
+            san += Types::PieceChar[Types::makePiece(WHITE, piece)];
+
+            // Disambiguate from other legal moves of the same piece type
+            // to the same square, by file, then rank, then both
+            bool ambiguous = false,
+                 sameFile = false,
+                 sameRank = false;
+            auto gen = MoveGen::Generator(&board);
+            gen.run();
+
+            for (auto& other : gen.moves)
+            {
+                if (other.to() != to
+                    || other.from() == from
+                    || board.getPieceType(other.from()) != piece
+                    || !board.isLegalMove(other))
+                    continue;
+
+                ambiguous = true;
+                sameFile |= Types::getFile(other.from()) == Types::getFile(from);
+                sameRank |= Types::getRank(other.from()) == Types::getRank(from);
+            }
+
+            if (ambiguous && !sameFile)
+                san += fileChar(from);
+            else if (ambiguous && !sameRank)
+                san += rankChar(from);
+            else if (ambiguous)
+            {
+                san += fileChar(from);
+                san += rankChar(from);
+            }
+        }
+
+        if (move.type() != CASTLE)
+        {
+            if (isCapture)
+                san += 'x';
+
+            san += fileChar(to);
+            san += rankChar(to);
+
+            if (move.type() == PROMOTION)
+            {
+                san += '=';
+                san += Types::PieceChar[Types::makePiece(WHITE, move.promPiece())];
+            }
+        }
+
+        // Append check or mate symbol
+        board.make(move);
+        if (board.isCheck())
+            san += hasLegalMove(board) ? '+' : '#';
+        board.unmake();
+
+        return san;
+    }
+
+    std::string toUCI(Move move)
+    {
+        std::string uci;
+        uci += fileChar(move.from());
+        uci += rankChar(move.from());
+        uci += fileChar(move.to());
+        uci += rankChar(move.to());
+
+        if (move.type() == PROMOTION)
+            uci += Types::PieceChar[Types::makePiece(BLACK, move.promPiece())];
+
+        return uci;
+    }
+
+    Move fromSAN(Board& board, std::string_view san)
+    {
+        // Strip check, mate and annotation symbols
+        while (!san.empty() && std::strchr("+#!?", san.back()))
+            san.remove_suffix(1);
+
+        // Decode the moved piece, destination, promotion and disambiguation
+        bool isCastle = false;
+        File castleFile = FILE1,
+             fromFile = File(-1);
+        Rank fromRank = Rank(-1);
+        PieceType piece = PAWN,
+                  promotion = NONE;
+        Square to = A1;
+
+        if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+        {
+            isCastle = true;
+            castleFile = san.size() == 3 ? FILE7 : FILE3;
+        }
+        else
+        {
+            if (!san.empty() && pieceType(san.front()) != NONE)
+            {
+                piece = pieceType(san.front());
+                san.remove_prefix(1);
+            }
+
+            // Promotion, as "=Q" or "Q"
+            if (piece == PAWN && !san.empty() && pieceType(san.back()) != NONE)
+            {
+                promotion = pieceType(san.back());
+                san.remove_suffix(1);
+                if (!san.empty() && san.back() == '=')
+                    san.remove_suffix(1);
+            }
+
+            if (san.size() < 2 || !isFile(san[san.size()-2]) || !isRank(san.back()))
+                return Move();
+
+            to = Types::getSquare(File(san[san.size()-2] - 'a'), Rank(san.back() - '1'));
+            san.remove_suffix(2);
+
+            for (char c : san)
+            {
+                if (isFile(c))
+                    fromFile = File(c - 'a');
+                else if (isRank(c))
+                    fromRank = Rank(c - '1');
+                else if (c != 'x' && c != ':' && c != '-')
+                    return Move();
+            }
+        }
+
+        // Match against the generated moves, only checking the legality
+        // of candidates, and rejecting ambiguous moves
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+
+        Move found = Move();
+        for (auto& move : gen.moves)
+        {
+            if (isCastle)
+            {
+                if (move.type() != CASTLE || Types::getFile(move.to()) != castleFile)
+                    continue;
+            }
+            else if (move.to() != to
+                     || move.type() == CASTLE
+                     || board.getPieceType(move.from()) != piece
+                     || (fromFile >= 0 && Types::getFile(move.from()) != fromFile)
+                     || (fromRank >= 0 && Types::getRank(move.from()) != fromRank)
+                     || (move.type() == PROMOTION ? move.promPiece() != promotion : promotion != NONE))
+                continue;
+
+            if (!board.isLegalMove(move))
+                continue;
+            if (!found.isNullMove())
+                return Move();
+
+            found = move;
+        }
+
+        return found;
+    }
+
+    Move fromUCI(Board& board, std::string_view uci)
+    {
+        if (uci.size() < 4 || !isFile(uci[0]) || !isRank(uci[1]) || !isFile(uci[2]) || !isRank(uci[3]))
+            return Move();
+
+        Square from = Types::getSquare(File(uci[0] - 'a'), Rank(uci[1] - '1')),
+               to = Types::getSquare(File(uci[2] - 'a'), Rank(uci[3] - '1'));
+        PieceType promotion = uci.size() > 4 ? pieceType(static_cast<char>(uci[4] - 'a' + 'A')) : NONE;
+
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+
+        for (auto& move : gen.moves)
+        {
+            if (move.from() == from && move.to() == to
+                && (move.type() == PROMOTION ? move.promPiece() == promotion : promotion == NONE))
+                return board.isLegalMove(move) ? move : Move();
+        }
+
+        return Move();
+    }
+
+}
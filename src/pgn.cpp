@@ -0,0 +1,271 @@
+#include "pgn.hpp"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace PGN {
+
+    std::string_view Game::tag(std::string_view name) const
+    {
+        for (auto& tag : tags)
+            if (tag.first == name)
+                return tag.second;
+
+        return std::string_view();
+    }
+
+    static inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    bool Reader::next(Game& game)
+    {
+        game.tags.clear();
+        game.movetext = std::string_view();
+        game.result = std::string_view();
+
+        size_t size = _text.size();
+        while (_pos < size && isSpace(_text[_pos]))
+            _pos++;
+        if (_pos >= size)
+            return false;
+
+        // Tag pairs, one per line: [Name "Value"]
+        while (_pos < size && _text[_pos] == '[')
+        {
+            size_t end = std::min(_text.find('\n', _pos), size);
+            auto line = _text.substr(_pos, end - _pos);
+
+            size_t space = line.find(' '),
+                   open = line.find('"'),
+                   close = line.rfind('"');
+            if (space != std::string_view::npos && open != std::string_view::npos && close > open)
+                game.tags.emplace_back(line.substr(1, space - 1), line.substr(open + 1, close - open - 1));
+
+            _pos = end;
+            while (_pos < size && isSpace(_text[_pos]))
+                _pos++;
+        }
+
+        // The movetext runs up to the next line starting a tag section,
+        // skipping over comments, which may span lines
+        size_t start = _pos;
+        while (_pos < size)
+        {
+            _pos = std::min(_text.find_first_of("{\n", _pos), size);
+            if (_pos == size)
+                break;
+
+            if (_text[_pos] == '{')
+                _pos = std::min(_text.find('}', _pos), size - 1) + 1;
+            else if (_pos + 1 < size && _text[_pos+1] == '[')
+                break;
+            else
+                _pos++;
+        }
+
+        game.movetext = _text.substr(start, _pos - start);
+        game.result = game.tag("Result");
+
+        return true;
+    }
+
+    // Skip a token, up to the next delimiter
+    static inline size_t tokenEnd(std::string_view text)
+    {
+        size_t end = 0;
+        while (end < text.size() && !isSpace(text[end])
+               && text[end] != '{' && text[end] != '(' && text[end] != ')'
+               && text[end] != ';' && text[end] != '$')
+            end++;
+        return end;
+    }
+
+    bool nextSAN(std::string_view& movetext, std::string_view& san)
+    {
+        while (!movetext.empty())
+        {
+            char c = movetext.front();
+
+            if (isSpace(c) || c == ')')
+                movetext.remove_prefix(1);
+
+            // Comments
+            else if (c == '{' || c == ';')
+            {
+                size_t end = movetext.find(c == '{' ? '}' : '\n');
+                movetext.remove_prefix(end == std::string_view::npos ? movetext.size() : end + 1);
+            }
+
+            // Variations, which may be nested and contain comments
+            else if (c == '(')
+            {
+                int depth = 0;
+                size_t i = 0;
+                for (; i < movetext.size(); i++)
+                {
+                    if (movetext[i] == '{')
+                        i = std::min(movetext.find('}', i), movetext.size() - 1);
+                    else if (movetext[i] == '(')
+                        depth++;
+                    else if (movetext[i] == ')' && --depth == 0)
+                        break;
+                }
+                movetext.remove_prefix(std::min(i + 1, movetext.size()));
+            }
+
+            // Numeric annotation glyphs
+            else if (c == '$')
+            {
+                movetext.remove_prefix(1);
+                movetext.remove_prefix(tokenEnd(movetext));
+            }
+
+            else
+            {
+                auto token = movetext.substr(0, std::max<size_t>(1, tokenEnd(movetext)));
+                movetext.remove_prefix(token.size());
+
+                // Game termination markers end the movetext
+                if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+                {
+                    movetext = std::string_view();
+                    return false;
+                }
+
+                // Strip move numbers, like "12." or "12...", unless castling
+                if (token.front() >= '0' && token.front() <= '9' && token.substr(0, 3) != "0-0")
+                {
+                    size_t i = token.find_first_not_of("0123456789.");
+                    if (i == std::string_view::npos)
+                        continue;
+                    token.remove_prefix(i);
+                }
+
+                san = token;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<std::string_view> split(std::string_view text, unsigned nParts)
+    {
+        std::vector<std::string_view> parts;
+        size_t start = 0;
+
+        // Move each split point forward to the start of the next game
+        for (unsigned i = 1; i < nParts && start < text.size(); i++)
+        {
+            size_t end = std::max(start, text.size() / nParts * i);
+            end = text.find("\n[Event ", end);
+            if (end == std::string_view::npos)
+                break;
+
+            parts.push_back(text.substr(start, end + 1 - start));
+            start = end + 1;
+        }
+
+        if (start < text.size())
+            parts.push_back(text.substr(start));
+
+        return parts;
+    }
+
+    const static size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+    int main(const VecStr& args)
+    {
+        // Parse "pgn --input <file> [--output <file>] [--threads <x>]"
+        std::string input = "",
+                    output = "";
+        unsigned nThreads = 1;
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            if (args.at(i) == "--input")
+                input = args.at(++i);
+            else if (args.at(i) == "--output")
+                output = args.at(++i);
+            else if (args.at(i) == "--threads")
+                nThreads = (unsigned)std::max(1, std::stoi(args.at(++i)));
+        }
+
+        MappedFile file(input);
+        if (!file.isOpen())
+        {
+            std::cerr << "Cannot open " << input << std::endl;
+            return 1;
+        }
+
+        std::ofstream ofs;
+        if (!output.empty())
+            ofs.open(output);
+
+        std::mutex outputMutex;
+        std::vector<std::string> buffers(nThreads);
+        std::atomic<U64> nGames(0),
+                         nPositions(0),
+                         nErrors(0);
+        auto start = high_resolution_clock::now();
+
+        // Extract every position with its game's result, as EPD lines,
+        // buffered per thread
+        parallelForEach(file.text(), nThreads, [&](unsigned thread, const Game& game)
+        {
+            std::string& buffer = buffers[thread];
+            U64 n = 0;
+
+            bool ok = replay(game, [&](Board& board, Move)
+            {
+                n++;
+                if (output.empty())
+                    return;
+
+                std::string fen = board.toFEN();
+                size_t end = 0;
+                for (int i = 0; i < 4 && end != std::string::npos; i++)
+                    end = fen.find(' ', end + 1);
+
+                buffer.append(fen, 0, end);
+                buffer += " c9 \"";
+                buffer += game.result;
+                buffer += "\";\n";
+            });
+
+            nGames++;
+            nPositions += n;
+            if (!ok)
+                nErrors++;
+
+            if (buffer.size() > OUTPUT_BUFFER_SIZE)
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                ofs << buffer;
+                buffer.clear();
+            }
+        });
+
+        for (auto& buffer : buffers)
+            ofs << buffer;
+
+        duration<double> d = duration_cast<duration<double>>(high_resolution_clock::now() - start);
+        std::cerr << "games " << nGames
+                  << " positions " << nPositions
+                  << " errors " << nErrors
+                  << " time " << (int)(d.count() * 1000)
+                  << " games/s " << (U64)(nGames / std::max(d.count(), 1e-9))
+                  << std::endl;
+
+        return 0;
+    }
+
+}
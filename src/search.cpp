@@ -1,19 +1,123 @@
 #include <algorithm>
 #include <cstdlib>
+#include <cmath>
 #include "search.hpp"
 #include "movegen.hpp"
 #include "board.hpp"
 #include "tt.hpp"
+#include "endgame.hpp"
+#include "tablebase.hpp"
 
 using namespace std::chrono;
 
+int Search::reductions[Search::MAX_DEPTH][Search::MAX_MOVES];
+
+// A null stream makes the search silent, so that nothing is formatted
+// and no stream state is shared between searches on other threads
+void Search::setOutput(std::ostream* os)
+{
+    _out = os;
+}
+
 void Search::think(int depth)
+{
+    SearchLimits limits;
+    limits.depth = depth;
+    think(limits);
+}
+
+void Search::think(const SearchLimits& searchLimits)
 {
     reset();
+    limits = searchLimits;
 
-    for (int i = 1; i < depth + 1; i++)
+    // Build the root move list, initially ordered like any other node
+    auto gen = MoveGen::Generator(_board);
+    gen.run();
+    TT::Entry* entry = _tt->probe(_board->getKey());
+    sortMoves(gen.moves, entry ? entry->best : Move());
+
+    rootMoves.clear();
+    for (auto& move : gen.moves)
+        if (_board->isLegalMove(move))
+            rootMoves.push_back(RootMove(move));
+
+    // No more lines than legal root moves can be searched
+    // A mate search only looks for a single line
+    int nLines = std::max(1, std::min(options.multiPV, (int)rootMoves.size()));
+    if (limits.mate)
+        nLines = 1;
+    pvLines.assign((U32)nLines, PVLine());
+
+    // A mate search only needs to prove a score of at least mate in N,
+    // going a few plies past the mate to allow for reductions
+    int mateAlpha = MATESCORE - 2 * limits.mate;
+    int maxDepth = MAX_DEPTH - 1;
+    if (limits.mate)
+        maxDepth = std::min(maxDepth, 2 * limits.mate - 1 + MATE_DEPTH_MARGIN);
+    if (limits.depth)
+        maxDepth = std::min(maxDepth, limits.depth);
+
+    // The best move of the last complete iteration
+    Move prevBest = Move();
+
+    for (int i = 1; i < maxDepth + 1; i++)
     {
-        bestScore = negamax<true>(i, -MATESCORE, MATESCORE);
+        // Keep the previous iteration's results for ordering, and start
+        // collecting this iteration's scores and subtree sizes
+        for (auto& rootMove : rootMoves)
+        {
+            rootMove.prevScore = rootMove.score;
+            rootMove.score = -MATESCORE;
+            rootMove.nodes = 0;
+        }
+
+        // Search each line in turn, excluding the moves of the lines before it
+        // The TT and history tables are shared, so later lines are cheaper
+        std::vector<PVLine> completedLines = pvLines;
+        for (pvIndex = 0; pvIndex < nLines; pvIndex++)
+        {
+            PVLine& pvLine = pvLines[(U32)pvIndex];
+            int score = limits.mate ? negamax<true>(i, mateAlpha, MATESCORE)
+                                    : aspirationSearch(i, pvLine.score);
+
+            // Discard the results of an interrupted iteration
+            if (stopped)
+                break;
+
+            pvLine.score = score;
+            pvLine.length = getPV(pvLine.moves, i);
+            pvLine.move = pvLine.length > 0 ? pvLine.moves[0] : Move();
+        }
+
+        // Keep the lines of the last complete iteration, so that the best
+        // move, score and PV all come from it
+        if (stopped)
+        {
+            pvLines = completedLines;
+            break;
+        }
+
+        // Order lines by score, since a later line can beat an earlier one
+        std::stable_sort(pvLines.begin(), pvLines.end(),
+                         [](const PVLine& a, const PVLine& b) { return a.score > b.score; });
+        if (!(prevBest == pvLines[0].move))
+        {
+            // Remember when the best move was found, for time to solution
+            bestMoveTime = elapsed();
+            bestMoveNodes = nSearched;
+        }
+        bestMove = prevBest = pvLines[0].move;
+        bestScore = pvLines[0].score;
+        bestDepth = i;
+
+        // In a mate search, stop once a short enough mate is proven
+        if (limits.mate)
+        {
+            if (bestScore > mateAlpha)
+                break;
+            continue;
+        }
 
         if (abs(bestScore) > MATESCORE - 1000)
             break;
@@ -21,7 +125,85 @@ void Search::think(int depth)
             break;
     }
 
-    std::cout << "bestmove " << bestMove << std::endl;
+    // Fall back to the best ordered root move if no line was completed
+    if (bestMove.isNullMove() && !rootMoves.empty())
+    {
+        bestMove = rootMoves[0].move;
+        pvLines[0].move = pvLines[0].moves[0] = bestMove;
+        pvLines[0].length = 1;
+    }
+
+    if (!_out)
+        return;
+
+    *_out << "info string researches " << nResearches << std::endl;
+    *_out << "info string evalcache hits " << evalHits << "/" << evalProbes
+          << " (" << 100 * evalHits / std::max<U64>(1, evalProbes) << "%)" << std::endl;
+    if (debug)
+    {
+        U64 nEvals = std::max<U64>(1, lazyStats.evals);
+        *_out << "info string qsearch evals " << lazyStats.evals
+              << " lazy " << 100 * lazyStats.lazy / nEvals << "%"
+              << " no mobility " << 100 * lazyStats.noMobility / nEvals << "%"
+              << " errors " << lazyStats.errors
+              << " max gap " << lazyStats.maxGap
+              << " max mobility " << lazyStats.maxMobilityGap << std::endl;
+    }
+    *_out << "bestmove " << bestMove << std::endl;
+}
+
+int Search::aspirationSearch(int depth, int prevScore)
+{
+    // Aspiration windows
+    // Once the score has settled, search with a narrow window centered
+    // on the previous iteration's score, widening it on fail high/low
+    int delta = ASPIRATION_WINDOW;
+    int alpha = -MATESCORE,
+        beta = MATESCORE;
+    if (depth >= ASPIRATION_DEPTH)
+    {
+        alpha = std::max(prevScore - delta, (int)-MATESCORE);
+        beta = std::min(prevScore + delta, (int)MATESCORE);
+    }
+
+    while (true)
+    {
+        int score = negamax<true>(depth, alpha, beta);
+        if (stopped)
+            return score;
+
+        // Reorder the root moves so the best move is searched first, and the
+        // rest by how hard they were to refute
+        std::stable_sort(rootMoves.begin(), rootMoves.end());
+
+        if (score <= alpha && alpha > -MATESCORE)
+        {
+            // Fail low, the score is an upper bound
+            printPV(depth, score, TT_ALPHA);
+            beta = (alpha + beta) / 2;
+            alpha = std::max(score - delta, (int)-MATESCORE);
+        }
+        else if (score >= beta && beta < MATESCORE)
+        {
+            // Fail high, the score is a lower bound
+            printPV(depth, score, TT_BETA);
+            beta = std::min(score + delta, (int)MATESCORE);
+        }
+        else
+            return score;
+
+        nResearches++;
+        delta += delta / 2;
+    }
+}
+
+bool Search::isExcludedRootMove(Move move) const
+{
+    for (int i = 0; i < pvIndex; i++)
+        if (pvLines[(U32)i].move == move)
+            return true;
+
+    return false;
 }
 
 template<bool Root>
@@ -32,13 +214,26 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
     Move bestMoveSoFar = Move();
     NodeType ttType = TT_ALPHA;
 
-    if (Root) {
-        nSearched = 0;
+    if (Root)
         searchPly = 0;
-    }
+
+    // Unwind the search once it has been stopped
+    if (stopped)
+        return 0;
 
     // Clear the line
-    pv[searchPly].clear();
+    pvLength[searchPly] = searchPly;
+
+    // Drawn endgames that are recognized need no search
+    if (!Root && Endgame::isKnownDraw(*_board))
+        return DRAWSCORE;
+
+    // Positions in the tablebases are scored from their distance to mate
+    if (!Root && Tablebase::probe(*_board, score, searchPly))
+    {
+        tbHits++;
+        return score;
+    }
 
     // If in check, search deeper
     bool wasInCheck = _board->isCheck();
@@ -46,14 +241,16 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
         depth += 1;
 
     // If we've reach max depth, begin static evaluation of the board
-    if (depth == 0)
+    if (depth == 0 || searchPly >= MAX_DEPTH - 1)
         return quiesce(alpha, beta);
     
     // First check the transposition table
     Move hashMove = Move();
     TT::Entry* entry = nullptr;
+    int staticEval = TT::NO_EVAL;
+    bool isFutile = false;
     if (!Root) {
-        entry = TT::table.probe(_board->getKey());
+        entry = _tt->probe(_board->getKey());
 
         if (entry) {
             // If we have a table hit, use hash move for move ordering
@@ -92,6 +289,45 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
 
         }
 
+        // Static evaluation for shallow depth pruning
+        // Avoid in PV nodes, when in check, or when searching for mate
+        bool isPrunable = !isPV
+                       && !wasInCheck
+                       && abs(alpha) < MATESCORE - 1000
+                       && abs(beta) < MATESCORE - 1000;
+        if (isPrunable)
+            staticEval = evaluate(entry);
+
+        // Reverse futility pruning (static null move)
+        // If the static eval beats beta by a depth dependent margin,
+        // assume the opponent can't recover and fail high
+        if (isPrunable
+            && depth <= REVERSE_FUTILITY_DEPTH
+            && staticEval - options.reverseFutilityMargin * depth >= beta
+            && _board->getPieceCount(_board->stm) > 0)
+        {
+            return beta;
+        }
+
+        // Razoring
+        // If the static eval is far below alpha, drop into quiescence search
+        // and fail low unless a tactic is found to refute that
+        if (isPrunable
+            && depth <= RAZOR_DEPTH
+            && staticEval + options.razorMargin * depth <= alpha)
+        {
+            score = quiesce(alpha, beta);
+            if (depth == 1 || score <= alpha)
+                return score;
+        }
+
+        // Futility pruning
+        // At frontier nodes, quiet moves are unlikely to raise the
+        // static eval above alpha, so flag them to be skipped
+        isFutile = isPrunable
+                && depth <= FUTILITY_DEPTH
+                && staticEval + options.futilityMargin * depth <= alpha;
+
         // Null move pruning
         // Allow opponent to make two moves in a row, and
         // search for a beta cutoff at a reduced depth, R
@@ -105,6 +341,7 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
             && !wasInCheck
             && _board->getPieceCount(_board->stm) > 0)
         {
+            plyMove[searchPly] = Move();
             _board->makeNull();
             ++searchPly;
             score = -negamax<false>(depth-R-1, -beta, -beta+1, false, false);
@@ -117,68 +354,140 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
     }
 
     // Generate and sort moves
+    // The root reuses the root move list, ordered across iterations
     int nLegalMoves = 0;
+    int nQuiets = 0;
+    Move quiets[MAX_MOVES];
     auto gen = MoveGen::Generator(_board);
-    gen.run();
-    sortMoves(gen.moves, hashMove);
+    if (Root)
+    {
+        for (auto& rootMove : rootMoves)
+            gen.moves.push_back(rootMove.move);
+    }
+    else
+    {
+        gen.run();
+        sortMoves(gen.moves, hashMove);
+    }
 
     // For each move
+    U32 moveIndex = 0;
     for (auto& move : gen.moves)
     {
+        RootMove* rootMove = Root ? &rootMoves[moveIndex++] : nullptr;
+
+        // In MultiPV mode, skip root moves already reported by previous lines
+        if (Root && isExcludedRootMove(move))
+            continue;
+
         // First check if move is legal
         if (!_board->isLegalMove(move))
             continue;
-        else {
-            nSearched++;
+        else
             nLegalMoves++;
+
+        // Skip futile quiet moves, keeping at least one move searched
+        if (isFutile
+            && nLegalMoves > 1
+            && move.type() == NORMAL
+            && _board->getPieceType(move.to()) == NONE
+            && !_board->isCheckingMove(move))
+        {
+            continue;
+        }
+
+        // Stop the search once the node or time limit is reached
+        if (++nSearched >= limits.nodes && limits.nodes)
+            stopped = true;
+        if (limits.movetime
+            && (nSearched & TIME_CHECK_INTERVAL) == 0
+            && elapsed() >= limits.movetime)
+            stopped = true;
+
+        // Gather move information before it is made on the board
+        PieceType movePiece = _board->getPieceType(move.from());
+        bool isQuiet = move.type() != PROMOTION
+                    && move.type() != ENPASSANT
+                    && _board->getPieceType(move.to()) == NONE;
+        bool isKiller = move == killers[searchPly].move1
+                     || move == killers[searchPly].move2;
+        int historyScore = isQuiet ? quietHistory(move, movePiece) : 0;
+
+        // Report the root move being searched, once the search takes a while
+        U64 nodesBefore = nSearched;
+        if (Root && _out && elapsed() > CURRMOVE_DELAY)
+        {
+            *_out << "info depth " << depth
+                      << " currmove " << move
+                      << " currmovenumber " << nLegalMoves << std::endl;
         }
 
-        // Make the move
+        // Make the move, recording it for continuation history
+        plyMove[searchPly] = move;
+        plyPiece[searchPly] = movePiece;
         _board->make(move);
         searchPly++;
 
         // Late move reductions
-        // Search likely fail low nodes at a reduced depth
+        // Search likely fail low nodes at a reduced depth, using a
+        // log(depth) * log(move number) base reduction which is lowered for
+        // PV nodes, killers and moves with a good history
         int lmrReduction = 0;
-        if (!Root) {
-            if (!isPV
-                && depth > 3
-                && nLegalMoves > 3
-                && !wasInCheck
-                && !_board->isCheck()
-                && _board->state[_board->ply].captured == NONE
-                && move.type() != PROMOTION)
-            {
-                if (nLegalMoves > 8)
-                    lmrReduction += 2;
-                else
-                    lmrReduction += 1;
-            }
+        if (!Root
+            && depth >= 2
+            && nLegalMoves > 1
+            && isQuiet
+            && !wasInCheck
+            && !_board->isCheck())
+        {
+            lmrReduction = reductions[std::min(depth, MAX_DEPTH - 1)]
+                                     [std::min(nLegalMoves, MAX_MOVES - 1)];
+
+            if (isPV)
+                lmrReduction -= 1;
+            if (isKiller)
+                lmrReduction -= 1;
+            lmrReduction -= historyScore / HISTORY_REDUCTION_DIVISOR;
+
+            lmrReduction = std::max(0, std::min(lmrReduction, depth - 2));
         }
 
         // PVS search
         // Search first move, or PV move, with full window
-        int nextDepth = depth - lmrReduction - 1;
         if (bestScoreSoFar == -MATESCORE)
-            score = -negamax<false>(nextDepth, -beta, -alpha);
+            score = -negamax<false>(depth-1, -beta, -alpha, isPV);
         // For remaining moves, search with null window centered around alpha
-        // in order to quickly check if it is an improvement, re-searching if so
+        // in order to quickly check if it is an improvement
         else
         {
-            score = -negamax<false>(nextDepth, -alpha-1, -alpha, isPV=false);
-            if ((score > alpha) && (score < beta))
-                score = -negamax<false>(nextDepth, -beta, -alpha);
+            score = -negamax<false>(depth-lmrReduction-1, -alpha-1, -alpha, false);
+
+            // If a search with LMR raises alpha, re-search to full depth
+            // since we expected a bad move
+            if (score > alpha && lmrReduction > 0)
+                score = -negamax<false>(depth-1, -alpha-1, -alpha, false);
+
+            // If the move is still an improvement, re-search with full window
+            if (score > alpha && score < beta)
+                score = -negamax<false>(depth-1, -beta, -alpha, isPV);
         }
-        // If a search with LMR raises alpha, re-search to full depth
-        // since we expected a bad move
-        if (score > alpha && lmrReduction > 0)
-            score = -negamax<false>(depth-1, -beta, -alpha);
         bestScoreSoFar = std::max(bestScoreSoFar, score);
 
         // Undo the move on the board
         searchPly--;
         _board->unmake();
 
+        if (stopped)
+            return 0;
+
+        // Record the root move's subtree size, and its score if it is exact
+        // or a lower bound
+        if (Root)
+        {
+            rootMove->nodes += nSearched - nodesBefore;
+            rootMove->score = score > alpha ? score : -MATESCORE;
+        }
+
         if (score > alpha)
         {
             // Update best move if score is above lower bound
@@ -188,11 +497,12 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
             {
                 // If we have a beta cutoff, stop search since our opponent
                 // has better available moves one ply up
-                addToHistory(move, searchPly);
+                if (isQuiet)
+                    addToHistory(move, depth, quiets, nQuiets);
                 ttType = TT_BETA;
                 alpha = beta;
                 if (Root)
-                    printPV(depth, beta, nSearched);
+                    savePV(move);
                 break;
             }
 
@@ -201,11 +511,12 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
             savePV(move);
 
             if (Root)
-            {
-                bestMove = move;
-                printPV(depth, alpha, nSearched);
-            }
+                printPV(depth, alpha, TT_EXACT);
         }
+
+        // Remember quiet moves which failed to produce a cutoff
+        if (isQuiet && nQuiets < MAX_MOVES)
+            quiets[nQuiets++] = move;
     }
 
     // Mate and draw detection
@@ -221,19 +532,105 @@ int Search::negamax(int depth, int alpha, int beta, bool isPV, bool isNullAllowe
         alpha = DRAWSCORE;
 
     // Save search results in the transposition table
-    TT::table.save(_board->getKey(), depth, alpha, ttType, bestMoveSoFar);
+    // Skip roots searched with excluded moves, since the result is partial
+    if (!Root || pvIndex == 0)
+        _tt->save(_board->getKey(), depth, alpha, ttType, bestMoveSoFar,
+                  _board->getFullMoveCounter() >= Eval::KING_SAFETY_MOVES ? staticEval : TT::NO_EVAL);
 
     return alpha;
 }
 
+// The key of the position for the eval cache. Early on the move counter
+// is part of the eval, so it is mixed in, and TT evals are not used
+U64 Search::evalKey() const
+{
+    return _board->getKey() ^ std::min(Eval::KING_SAFETY_MOVES, _board->getFullMoveCounter());
+}
+
+// The static eval of the position, reused from its TT entry or the eval
+// cache when either has it
+int Search::evaluate(const TT::Entry* entry)
+{
+    evalProbes++;
+    if (entry
+        && entry->eval != TT::NO_EVAL
+        && _board->getFullMoveCounter() >= Eval::KING_SAFETY_MOVES)
+    {
+        evalHits++;
+        return entry->eval;
+    }
+
+    int eval;
+    U64 key = evalKey();
+    if (evalCache.probe(key, eval))
+    {
+        evalHits++;
+        return eval;
+    }
+
+    eval = _board->eval<false>();
+    evalCache.save(key, eval);
+    return eval;
+}
+
+// Count the quiescence evals cut short by lazy eval, and those where the
+// full eval would have decided differently, to check the margins
+void Search::verifyLazyEval(bool lazy, int score, int alpha, int beta)
+{
+    int full = _board->eval<false>();
+    // An empty window always stops the eval before mobility
+    int partial = _board->eval<false>(MATESCORE, -MATESCORE);
+    bool noMobility = partial <= alpha - options.lazyMobilityMargin
+                   || partial >= beta + options.lazyMobilityMargin;
+
+    lazyStats.evals++;
+    lazyStats.lazy += lazy;
+    lazyStats.noMobility += lazy || noMobility;
+    lazyStats.errors += (score >= beta) != (full >= beta) || (score > alpha) != (full > alpha);
+    lazyStats.maxGap = std::max(lazyStats.maxGap, abs(full - _board->lazyEval()));
+    lazyStats.maxMobilityGap = std::max(lazyStats.maxMobilityGap, abs(full - partial));
+}
+
 int Search::quiesce(int alpha, int beta)
 {
-    int score = _board->eval<false>();
-    
+    if (stopped)
+        return 0;
+
+    // Stand pat on a cached eval if there is one. Otherwise stand pat on
+    // material and piece squares alone when they are far enough outside
+    // the window that the rest of the eval cannot matter, and leave out
+    // mobility on the same terms
+    int score;
+    bool lazy = false;
+    U64 key = evalKey();
+    evalProbes++;
+    if (evalCache.probe(key, score))
+        evalHits++;
+    else
+    {
+        score = _board->lazyEval();
+        int margin = options.lazyEvalMargin,
+            lo = alpha - options.lazyMobilityMargin,
+            hi = beta + options.lazyMobilityMargin;
+        lazy = score - margin >= beta || score + margin <= alpha;
+        if (lazy)
+            score = score - margin >= beta ? beta : score + margin;
+        else
+        {
+            // Only an eval inside the window was computed in full
+            score = _board->eval<false>(lo, hi);
+            if (lo < score && score < hi)
+                evalCache.save(key, score);
+        }
+    }
+
+    if (debug)
+        verifyLazyEval(lazy, score, alpha, beta);
+
     if (score >= beta)
         return beta;
 
-    if (searchPly > MAX_DEPTH)
+    if (searchPly >= MAX_DEPTH - 1)
         return score;
 
     if (score > alpha)
@@ -251,6 +648,8 @@ int Search::quiesce(int alpha, int beta)
         else
             nLegalMoves++;
 
+        plyMove[searchPly] = move;
+        plyPiece[searchPly] = _board->getPieceType(move.from());
         _board->make(move);
         searchPly++;
 
@@ -259,6 +658,9 @@ int Search::quiesce(int alpha, int beta)
         searchPly--;
         _board->unmake();
 
+        if (stopped)
+            return 0;
+
         if (score >= beta)
             return beta;
         if (score > alpha)
@@ -298,129 +700,268 @@ U64 Search::perft(int depth)
         count = perft<false>(depth-1);
         nodes += count;
 
-        if (Root)
-            std::cout << move << ": " << count << std::endl;
+        if (Root && _out)
+            *_out << move << ": " << count << std::endl;
 
         _board->unmake();
     }
 
-    if (Root)
+    if (Root && _out)
     {
         stop = high_resolution_clock::now();
 
         duration<double> d = duration_cast<duration<double>>(stop - start);
-        std::cout << "TOTAL TIME OF SEARCH: " << d.count() << std::endl;
-        std::cout << "TOTAL NODES SEARCHED: " << nodes << std::endl;
-        std::cout << "NODES PER SECOND    : " << nodes / d.count() << std::endl;
+        *_out << "TOTAL TIME OF SEARCH: " << d.count() << std::endl;
+        *_out << "TOTAL NODES SEARCHED: " << nodes << std::endl;
+        *_out << "NODES PER SECOND    : " << nodes / d.count() << std::endl;
     }
 
     return nodes;
 }
 
+void Search::init()
+{
+    // Precompute the late move reduction table
+    for (int depth = 1; depth < MAX_DEPTH; depth++)
+        for (int n = 1; n < MAX_MOVES; n++)
+            reductions[depth][n] = (int)(0.75 + std::log(depth) * std::log(n) / 2.25);
+}
+
 void Search::reset()
 {
     // Reset the PV collector
-    for (int i = 0; i < MAX_DEPTH; i++)
-        pv[i].clear();
+    for (int i = 0; i < MAX_DEPTH + 1; i++)
+        pvLength[i] = 0;
 
-    // Zero the history table
+    // Zero the history, countermove and continuation history tables
     for (int c = 0; c < 2; c++) {
         for (int p = 0; p < 6; p++) {
             for (int sq = 0; sq < 64; sq++) {
                 history[c][p][sq] = 0;
+                counterMoves[c][p][sq] = Move();
             }
         }
     }
+    std::memset(contHistory.get(), 0, sizeof(ContHistory) * 2);
+
+    // Reset search statistics
+    bestMove = Move();
+    bestScore = 0;
+    bestDepth = 0;
+    bestMoveTime = 0;
+    bestMoveNodes = 0;
+    nSearched = 0;
+    nResearches = 0;
+    lazyStats = LazyEvalStats();
+    evalProbes = 0;
+    evalHits = 0;
+    tbHits = 0;
+    stopped = false;
 
     // Start the clock
     start = high_resolution_clock::now();
 }
 
-void Search::addToHistory(Move move, int ply)
+void Search::addToHistory(Move move, int depth, Move* quiets, int nQuiets)
 {
-    PieceType captPiece = _board->getPieceType(move.to());
-    if (captPiece == NONE && move.type() != PROMOTION)
+    Color stm = _board->stm;
+
+    // Add to killer moves
+    if (!(killers[searchPly].move1 == move))
     {
-        // Add to killer moves
-        killers[ply].move2 = killers[ply].move1;
-        killers[ply].move1 = move;
+        killers[searchPly].move2 = killers[searchPly].move1;
+        killers[searchPly].move1 = move;
+    }
 
-        // Add to history table
-        PieceType movePiece = _board->getPieceType(move.from());
-        history[_board->stm][movePiece-1][move.to()] += (U32)1 << (U64)ply; // ply^2
+    // Record the move as the refutation of the previous move
+    if (searchPly > 0 && !plyMove[searchPly-1].isNullMove())
+    {
+        Move prev = plyMove[searchPly-1];
+        counterMoves[stm][plyPiece[searchPly-1]-1][prev.to()] = move;
+    }
 
-        if (history[_board->stm][movePiece-1][move.to()] > 10000)
-        {
-            for (int c = 0; c < 2; c++) {
-                for (int p = 0; p < 6; p++) {
-                    for (int sq = 0; sq < 64; sq++) {
-                        history[c][p][sq] >>= 2;
-                    }
-                }
-            }
-        }
+    // Reward the cutoff move, and penalize the quiet moves tried before it
+    int bonus = std::min(depth * depth, (int)HISTORY_MAX_BONUS);
+    updateHistory(move, bonus);
+    for (int i = 0; i < nQuiets; i++)
+        updateHistory(quiets[i], -bonus);
+}
+
+void Search::updateHistory(Move move, int bonus)
+{
+    Color stm = _board->stm;
+    PieceType movePiece = _board->getPieceType(move.from());
+    Square to = move.to();
+
+    applyGravity(history[stm][movePiece-1][to], bonus);
+
+    // Update the one and two ply continuation histories
+    for (int i = 0; i < 2; i++)
+    {
+        int ply = searchPly - 1 - i;
+        if (ply < 0 || plyMove[ply].isNullMove())
+            break;
+
+        Move prev = plyMove[ply];
+        applyGravity(contHistory[(U32)i][stm][plyPiece[ply]-1][prev.to()][movePiece-1][to], bonus);
     }
 }
 
+int Search::quietHistory(Move move, PieceType movePiece) const
+{
+    Color stm = _board->stm;
+    Square to = move.to();
+    int score = history[stm][movePiece-1][to];
+
+    for (int i = 0; i < 2; i++)
+    {
+        int ply = searchPly - 1 - i;
+        if (ply < 0 || plyMove[ply].isNullMove())
+            break;
+
+        Move prev = plyMove[ply];
+        score += contHistory[(U32)i][stm][plyPiece[ply]-1][prev.to()][movePiece-1][to];
+    }
+
+    return score;
+}
 
 void Search::savePV(Move move)
 {
-    U32 ply = (U32) searchPly;
+    int ply = searchPly;
 
-    pv[ply].clear();
-    pv[ply].push_back(move);
-    
-    std::copy(pv[ply+1].begin(),
-              pv[ply+1].end(),
-              std::back_inserter(pv[ply]));
+    // Prepend the move to the line of the child node
+    pvTable[ply][ply] = move;
+    for (int i = ply + 1; i < pvLength[ply+1]; i++)
+        pvTable[ply][i] = pvTable[ply+1][i];
+
+    pvLength[ply] = std::max(pvLength[ply+1], ply + 1);
+}
+
+int Search::getPV(Move* line, int depth)
+{
+    // Start from the collected principal variation, or the line's previous
+    // best move if the current iteration has not produced a line yet
+    int length = pvLength[0];
+    for (int i = 0; i < length; i++)
+        line[i] = pvTable[0][i];
+
+    Move prevBest = (U32)pvIndex < pvLines.size() ? pvLines[(U32)pvIndex].move : bestMove;
+    if (length == 0 && !prevBest.isNullMove())
+        line[length++] = prevBest;
+
+    // Play out the line on the board
+    for (int i = 0; i < length; i++)
+        _board->make(line[i]);
+
+    // The line is truncated when a hash cut ends the search of a node,
+    // so extend it by following the best moves stored in the TT
+    int nMade = length;
+    while (length < depth && length < MAX_DEPTH)
+    {
+        TT::Entry* entry = _tt->probe(_board->getKey());
+        if (!entry || entry->best.isNullMove())
+            break;
+
+        // Verify the hash move is legal, since keys can collide
+        Move ttMove = entry->best;
+        auto gen = MoveGen::Generator(_board);
+        gen.run();
+        if (std::find(gen.moves.begin(), gen.moves.end(), ttMove) == gen.moves.end()
+            || !_board->isLegalMove(ttMove))
+            break;
+
+        _board->make(ttMove);
+        line[length++] = ttMove;
+        nMade++;
+    }
+
+    // Restore the board
+    for (int i = 0; i < nMade; i++)
+        _board->unmake();
+
+    return length;
+}
+
+int Search::elapsed()
+{
+    stop = high_resolution_clock::now();
+    return (int)duration_cast<milliseconds>(stop - start).count();
 }
 
-void Search::printPV(int depth, int score, unsigned int nSearched)
+void Search::printPV(int depth, int score, NodeType bound)
 {
+    if (!_out)
+        return;
+
     stop = high_resolution_clock::now();
     duration<double> d = duration_cast<duration<double>>(stop - start);
 
-    std::cout << "info depth " << depth;
-    std::cout << " score cp " << score;
-    std::cout << " nodes " << nSearched;
-    std::cout << " nps " << (U32)(nSearched / d.count());
-    std::cout << " time " << (int)(d.count() * 1000) << "\n";
-    
-    std::cout << "pv ";
-    for (auto& m : pv[0])
-        std::cout << m << " ";
-    std::cout << std::endl;
+    *_out << "info depth " << depth;
+    if (options.multiPV > 1)
+        *_out << " multipv " << pvIndex + 1;
+    if (abs(score) > MATESCORE - 1000)
+    {
+        // Report mate scores in moves, negative if being mated
+        int mateIn = (MATESCORE - abs(score) + 1) / 2;
+        *_out << " score mate " << (score > 0 ? mateIn : -mateIn);
+    }
+    else
+        *_out << " score cp " << score;
+    if (bound == TT_BETA)
+        *_out << " lowerbound";
+    else if (bound == TT_ALPHA)
+        *_out << " upperbound";
+    *_out << " nodes " << nSearched;
+    if (tbHits)
+        *_out << " tbhits " << tbHits;
+    *_out << " nps " << (U64)(nSearched / d.count());
+    *_out << " time " << (int)(d.count() * 1000);
+
+    Move line[MAX_DEPTH];
+    int length = getPV(line, depth);
+    *_out << " pv";
+    for (int i = 0; i < length; i++)
+        *_out << " " << line[i];
+    *_out << std::endl;
 }
 
 
 void Search::sortMoves(std::vector<Move>& moves, Move hashmove)
 {
+    // Get the refutation of the previous move, if any
+    Move counterMove = Move();
+    if (searchPly > 0 && !plyMove[searchPly-1].isNullMove())
+    {
+        Move prev = plyMove[searchPly-1];
+        counterMove = counterMoves[_board->stm][plyPiece[searchPly-1]-1][prev.to()];
+    }
+
     for (auto& move : moves)
     {
-        if (move == bestMove)
-            move.score += 10001;
-        
         if (move == hashmove && !hashmove.isNullMove())
             move.score += 10000;
 
         if (move.type() == PROMOTION)
-            move.score += 1000 + move.promPiece();
+            move.score += 5000 + move.promPiece();
 
+        PieceType movePiece = _board->getPieceType(move.from());
         PieceType captPiece = _board->getPieceType(move.to());
-        if (captPiece != NONE) {
-            PieceType movePiece = _board->getPieceType(move.from());
-            move.score += Eval::PieceValues[captPiece-1][WHITE] - movePiece;
-        }
-        else {
-            PieceType movePiece = _board->getPieceType(move.from());
-            move.score += (I32)history[_board->stm][movePiece-1][move.to()];
-        }
+        if (captPiece != NONE)
+            move.score += 4000 + Eval::PieceValues[captPiece-1][WHITE] - movePiece;
 
-        if (move == killers[searchPly].move1)
-            move.score += 100;
-
-        if (move == killers[searchPly].move2)
-            move.score += 50;
+        else if (move.type() != PROMOTION)
+        {
+            // Order quiet moves by killers, countermove, then history
+            if (move == killers[searchPly].move1)
+                move.score += 3000;
+            else if (move == killers[searchPly].move2)
+                move.score += 2900;
+            else if (move == counterMove)
+                move.score += 2800;
+            else
+                move.score += quietHistory(move, movePiece) / 32;
+        }
     }
 
     std::stable_sort(moves.rbegin(), moves.rend());
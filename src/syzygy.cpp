@@ -0,0 +1,983 @@
+#include "syzygy.hpp"
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include "globals.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "material.hpp"
+#include "mappedfile.hpp"
+
+namespace Syzygy {
+
+    enum TableType { WDL_TABLE, DTZ_TABLE };
+
+    static const U8 MAGIC[2][4] = { { 0x71, 0xE8, 0x23, 0x5D },
+                                    { 0xD7, 0x66, 0x0C, 0xA5 } };
+    static const std::string EXTENSIONS[2] = { ".rtbw", ".rtbz" };
+
+    // Flags of a file, then of each side and pawn file it holds
+    enum TableFlag : U8 { SPLIT = 1, HAS_PAWNS = 2 };
+    enum PairsFlag : U8 { STM = 1, MAPPED = 2, WIN_PLIES = 4, LOSS_PLIES = 8, WIDE = 16, SINGLE_VALUE = 128 };
+
+    // How a probe went: failed for a missing table, found the table holds
+    // the other side to move, or found the best move zeroes the counter
+    enum State { FAIL, OK, CHANGE_STM, ZEROING };
+
+    // Larger than any distance to zeroing, for ranking root moves
+    const int MAX_DTZ = 1 << 18;
+
+    /**
+     *  Position indexing
+     */
+
+    static int binomial[6][64];
+    static int mapPawns[64];
+    static int leadPawnIdx[6][64];
+    static int leadPawnsSize[6][4];
+    static int mapB1H1H7[64];
+    static int mapA1D1D4[64];
+    static int mapKK[10][64];
+
+    static inline int fileOf(int sq) { return sq & 7; }
+    static inline int rankOf(int sq) { return sq >> 3; }
+
+    // Positive above the a1-h8 diagonal, negative below it
+    static inline int offDiagonal(int sq) { return rankOf(sq) - fileOf(sq); }
+
+    // The leading pawn is the one nearest the edge, then the lowest
+    static inline bool pawnsBefore(int a, int b) { return mapPawns[a] < mapPawns[b]; }
+
+    static void init()
+    {
+        if (binomial[0][0])
+            return;
+
+        int code = 0;
+        for (int sq = 0; sq < 64; sq++)
+            if (offDiagonal(sq) < 0)
+                mapB1H1H7[sq] = code++;
+
+        // The a1-d1-d4 triangle, its diagonal squares last
+        std::vector<int> diagonal;
+        code = 0;
+        for (int sq = A1; sq <= D4; sq++)
+        {
+            if (offDiagonal(sq) < 0 && fileOf(sq) <= 3)
+                mapA1D1D4[sq] = code++;
+            else if (!offDiagonal(sq) && fileOf(sq) <= 3)
+                diagonal.push_back(sq);
+        }
+        for (int sq : diagonal)
+            mapA1D1D4[sq] = code++;
+
+        // The 462 placements of two kings with the first in the triangle,
+        // and the second not above the diagonal if the first is on it
+        std::vector<std::pair<int, int>> bothOnDiagonal;
+        code = 0;
+        for (int idx = 0; idx < 10; idx++)
+            for (int s1 = A1; s1 <= D4; s1++)
+                if (mapA1D1D4[s1] == idx && (idx || s1 == B1))
+                    for (int s2 = 0; s2 < 64; s2++)
+                    {
+                        if (G::DISTANCE[s1][s2] <= 1)
+                            continue;
+                        if (!offDiagonal(s1) && offDiagonal(s2) > 0)
+                            continue;
+
+                        if (!offDiagonal(s1) && !offDiagonal(s2))
+                            bothOnDiagonal.emplace_back(idx, s2);
+                        else
+                            mapKK[idx][s2] = code++;
+                    }
+        for (auto& kings : bothOnDiagonal)
+            mapKK[kings.first][kings.second] = code++;
+
+        binomial[0][0] = 1;
+        for (int n = 1; n < 64; n++)
+            for (int k = 0; k < 6 && k <= n; k++)
+                binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0)
+                               + (k < n ? binomial[k][n - 1] : 0);
+
+        // Pawn squares from a2 to h7, counting down from the edges and
+        // the second rank, and the indices of the leading pawns by file
+        int available = 47;
+        for (int leadPawns = 1; leadPawns <= 5; leadPawns++)
+            for (int f = 0; f < 4; f++)
+            {
+                int idx = 0;
+                for (int r = 1; r <= 6; r++)
+                {
+                    int sq = 8 * r + f;
+                    if (leadPawns == 1)
+                    {
+                        mapPawns[sq] = available--;
+                        mapPawns[sq ^ 7] = available--;
+                    }
+                    leadPawnIdx[leadPawns][sq] = idx;
+                    idx += binomial[leadPawns - 1][mapPawns[sq]];
+                }
+                leadPawnsSize[leadPawns][f] = idx;
+            }
+    }
+
+    /**
+     *  Tables
+     */
+
+    static inline U16 readLE16(const U8* p) { U16 x; std::memcpy(&x, p, 2); return x; }
+    static inline U32 readLE32(const U8* p) { U32 x; std::memcpy(&x, p, 4); return x; }
+    static inline U32 readBE32(const U8* p) { return __builtin_bswap32(readLE32(p)); }
+    static inline U64 readBE64(const U8* p) { U64 x; std::memcpy(&x, p, 8); return __builtin_bswap64(x); }
+
+    // Symbols of the compressed data are pairs of 12 bit symbols, packed
+    // in 3 bytes, with a leaf holding its value on the left
+    static inline U16 left(const U8* btree, size_t sym)
+    {
+        return U16(((btree[3 * sym + 1] & 0xF) << 8) | btree[3 * sym]);
+    }
+
+    static inline U16 right(const U8* btree, size_t sym)
+    {
+        return U16((btree[3 * sym + 2] << 4) | (btree[3 * sym + 1] >> 4));
+    }
+
+    // The values of one side to move and pawn file, compressed by recursive
+    // pairing and canonical Huffman codes, in blocks found through a sparse index
+    struct Pairs
+    {
+        U8 flags = 0;
+        int minSymLen = 0;
+        int maxSymLen = 0;
+        U64 blockSize = 0;
+        U64 span = 0;
+        U64 sparseIndexSize = 0;
+        U64 blocks = 0;
+        U64 blockLengthSize = 0;
+        const U8* lowestSym = nullptr;
+        const U8* btree = nullptr;
+        const U8* sparseIndex = nullptr;
+        const U8* blockLength = nullptr;
+        const U8* data = nullptr;
+        std::vector<U64> base64;
+        std::vector<U8> symlen;
+        U8 pieces[MAX_PIECES] = {};
+        int groupLen[MAX_PIECES + 1] = {};
+        U64 groupIdx[MAX_PIECES + 1] = {};
+        U16 mapIdx[4] = {};
+    };
+
+    struct Table
+    {
+        TableType type = WDL_TABLE;
+        U64 key = 0;        // With the side named first as white
+        U64 key2 = 0;       // With the side named first as black
+        int pieceCount = 0;
+        bool hasPawns = false;
+        bool hasUniquePieces = false;
+        int pawnCount[2] = {};  // Of the leading color, then the other
+        std::unique_ptr<MappedFile> file;
+        const U8* map = nullptr;
+        Pairs items[2][4];
+
+        // Distance to zeroing tables hold a single side to move
+        inline Pairs& get(int stm, int f)
+        {
+            return items[type == WDL_TABLE ? stm : 0][hasPawns ? f : 0];
+        }
+        inline const Pairs& get(int stm, int f) const
+        {
+            return items[type == WDL_TABLE ? stm : 0][hasPawns ? f : 0];
+        }
+    };
+
+    static std::vector<std::unique_ptr<Table>> tables;
+    static std::unordered_map<U64, std::pair<const Table*, const Table*>> byMaterial;
+    static int largestTable = 0;
+
+    // The groups of pieces indexed together, and the factor of each group
+    // in the index, in the order the table gives
+    static bool setGroups(const Table& table, Pairs& d, const int order[2], int f)
+    {
+        int n = 0,
+            firstLen = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+        d.groupLen[n] = 1;
+        for (int i = 1; i < table.pieceCount; i++)
+        {
+            if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1])
+                d.groupLen[n]++;
+            else
+                d.groupLen[++n] = 1;
+        }
+        d.groupLen[++n] = 0;
+
+        if (table.hasPawns && d.groupLen[0] > 5)
+            return false;
+
+        bool bothPawns = table.hasPawns && table.pawnCount[1];
+        int next = bothPawns ? 2 : 1,
+            freeSquares = 64 - d.groupLen[0] - (bothPawns ? d.groupLen[1] : 0);
+        U64 idx = 1;
+
+        for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+        {
+            if (k == order[0])
+            {
+                d.groupIdx[0] = idx;
+                idx *= table.hasPawns ? (U64)leadPawnsSize[d.groupLen[0]][f]
+                     : table.hasUniquePieces ? 31332 : 462;
+            }
+            else if (k == order[1])
+            {
+                d.groupIdx[1] = idx;
+                idx *= (U64)binomial[d.groupLen[1]][48 - d.groupLen[0]];
+            }
+            else
+            {
+                if (d.groupLen[next] > 5)
+                    return false;
+                d.groupIdx[next] = idx;
+                idx *= (U64)binomial[d.groupLen[next]][freeSquares];
+                freeSquares -= d.groupLen[next++];
+            }
+        }
+        d.groupIdx[n] = idx;
+        return true;
+    }
+
+    // The number of values a symbol expands to, less one
+    static U8 symbolLength(Pairs& d, size_t sym, std::vector<bool>& visited)
+    {
+        visited[sym] = true;
+        size_t r = right(d.btree, sym);
+        if (r == 0xFFF)
+            return 0;
+
+        size_t l = left(d.btree, sym);
+        if (l >= d.symlen.size() || r >= d.symlen.size())
+            return 0;
+        if (!visited[l])
+            d.symlen[l] = symbolLength(d, l, visited);
+        if (!visited[r])
+            d.symlen[r] = symbolLength(d, r, visited);
+
+        return U8(d.symlen[l] + d.symlen[r] + 1);
+    }
+
+    static const U8* setSizes(Pairs& d, const U8* data)
+    {
+        d.flags = *data++;
+        if (d.flags & SINGLE_VALUE)
+        {
+            // The single value is kept as the minimum symbol length
+            d.minSymLen = *data++;
+            return data;
+        }
+
+        int n = 0;
+        while (d.groupLen[n])
+            n++;
+        U64 size = d.groupIdx[n];
+
+        d.blockSize = 1ULL << *data++;
+        d.span = 1ULL << *data++;
+        d.sparseIndexSize = (size + d.span - 1) / d.span;
+        U8 padding = *data++;
+        d.blocks = readLE32(data);
+        data += 4;
+        d.blockLengthSize = d.blocks + padding;
+        d.maxSymLen = *data++;
+        d.minSymLen = *data++;
+        if (d.minSymLen < 1 || d.maxSymLen < d.minSymLen || d.maxSymLen > 32)
+            return nullptr;
+
+        // The first code of each length, left aligned in 64 bits, longer
+        // codes having lower values
+        d.lowestSym = data;
+        d.base64.assign(size_t(d.maxSymLen - d.minSymLen + 1), 0);
+        for (int i = (int)d.base64.size() - 2; i >= 0; i--)
+            d.base64[(size_t)i] = (d.base64[(size_t)i + 1] + readLE16(d.lowestSym + 2 * i)
+                                   - readLE16(d.lowestSym + 2 * (i + 1))) / 2;
+        for (size_t i = 0; i < d.base64.size(); i++)
+            d.base64[i] <<= 64 - i - (size_t)d.minSymLen;
+        data += 2 * d.base64.size();
+
+        d.symlen.assign(readLE16(data), 0);
+        data += 2;
+        d.btree = data;
+        std::vector<bool> visited(d.symlen.size());
+        for (size_t sym = 0; sym < d.symlen.size(); sym++)
+            if (!visited[sym])
+                d.symlen[sym] = symbolLength(d, sym, visited);
+
+        return data + 3 * d.symlen.size() + (d.symlen.size() & 1);
+    }
+
+    // Distance to zeroing tables may map their values through a list for
+    // each result
+    static const U8* setMap(Table& table, const U8* begin, const U8* data, int maxFile)
+    {
+        table.map = data;
+        for (int f = 0; f <= maxFile; f++)
+        {
+            Pairs& d = table.get(0, f);
+            if (!(d.flags & MAPPED))
+                continue;
+
+            if (d.flags & WIDE)
+            {
+                data += (data - begin) & 1;
+                for (int i = 0; i < 4; i++)
+                {
+                    d.mapIdx[i] = U16((data - table.map) / 2 + 1);
+                    data += 2 * readLE16(data) + 2;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    d.mapIdx[i] = U16(data - table.map + 1);
+                    data += *data + 1;
+                }
+            }
+        }
+        return data + ((data - begin) & 1);
+    }
+
+    // Read the layout of a mapped table, keeping pointers into the file
+    static bool parse(Table& table)
+    {
+        const U8* begin = reinterpret_cast<const U8*>(table.file->data());
+        const U8* end = begin + table.file->size();
+        const U8* data = begin;
+        if (table.file->size() < 8 || std::memcmp(data, MAGIC[table.type], 4))
+            return false;
+        data += 4;
+
+        bool split = table.key != table.key2;
+        if (bool(*data & HAS_PAWNS) != table.hasPawns || bool(*data & SPLIT) != split)
+            return false;
+        data++;
+
+        int sides = table.type == WDL_TABLE && split ? 2 : 1,
+            maxFile = table.hasPawns ? 3 : 0;
+        bool bothPawns = table.hasPawns && table.pawnCount[1];
+
+        for (int f = 0; f <= maxFile; f++)
+        {
+            int order[2][2] = { { *data & 0xF, bothPawns ? *(data + 1) & 0xF : 0xF },
+                                { *data >> 4,  bothPawns ? *(data + 1) >> 4  : 0xF } };
+            data += 1 + bothPawns;
+
+            for (int k = 0; k < table.pieceCount; k++, data++)
+                for (int i = 0; i < sides; i++)
+                    table.get(i, f).pieces[k] = U8(i ? *data >> 4 : *data & 0xF);
+
+            for (int i = 0; i < sides; i++)
+                if (!setGroups(table, table.get(i, f), order[i], f))
+                    return false;
+        }
+        data += (data - begin) & 1;
+
+        for (int f = 0; f <= maxFile; f++)
+            for (int i = 0; i < sides; i++)
+                if (data >= end || !(data = setSizes(table.get(i, f), data)))
+                    return false;
+
+        if (table.type == DTZ_TABLE)
+            data = setMap(table, begin, data, maxFile);
+
+        for (int f = 0; f <= maxFile; f++)
+            for (int i = 0; i < sides; i++)
+            {
+                Pairs& d = table.get(i, f);
+                d.sparseIndex = data;
+                data += 6 * d.sparseIndexSize;
+            }
+
+        for (int f = 0; f <= maxFile; f++)
+            for (int i = 0; i < sides; i++)
+            {
+                Pairs& d = table.get(i, f);
+                d.blockLength = data;
+                data += 2 * d.blockLengthSize;
+            }
+        if (data > end)
+            return false;
+
+        for (int f = 0; f <= maxFile; f++)
+            for (int i = 0; i < sides; i++)
+            {
+                Pairs& d = table.get(i, f);
+                if (!d.blocks)
+                    continue;
+
+                data += (64 - (data - begin) % 64) % 64;
+                d.data = data;
+                data += d.blocks * d.blockSize;
+                if (data > end)
+                    return false;
+            }
+
+        return true;
+    }
+
+    // The value at an index: find its block from the nearest entry of the
+    // sparse index, then decode symbols until the one holding it
+    static int decompress(const Pairs& d, U64 idx)
+    {
+        if (d.flags & SINGLE_VALUE)
+            return d.minSymLen;
+
+        U64 k = idx / d.span;
+        U32 block = readLE32(d.sparseIndex + 6 * k);
+        int offset = readLE16(d.sparseIndex + 6 * k + 4);
+        offset += int(idx % d.span) - int(d.span / 2);
+
+        while (offset < 0)
+            offset += readLE16(d.blockLength + 2 * --block) + 1;
+        while (offset > readLE16(d.blockLength + 2 * block))
+            offset -= readLE16(d.blockLength + 2 * block++) + 1;
+
+        const U8* ptr = d.data + block * d.blockSize;
+        U64 buf64 = readBE64(ptr);
+        ptr += 8;
+        int buf64Size = 64;
+        size_t sym;
+
+        while (true)
+        {
+            size_t len = 0;
+            while (buf64 < d.base64[len])
+                len++;
+
+            sym = size_t((buf64 - d.base64[len]) >> (64 - len - (size_t)d.minSymLen));
+            sym += readLE16(d.lowestSym + 2 * len);
+            if (offset < d.symlen[sym] + 1)
+                break;
+
+            offset -= d.symlen[sym] + 1;
+            len += (size_t)d.minSymLen;
+            buf64 <<= len;
+            buf64Size -= (int)len;
+            if (buf64Size <= 32)
+            {
+                buf64Size += 32;
+                buf64 |= U64(readBE32(ptr)) << (64 - buf64Size);
+                ptr += 4;
+            }
+        }
+
+        // Expand the symbol down to the value at the offset
+        while (d.symlen[sym])
+        {
+            size_t l = left(d.btree, sym);
+            if (offset < d.symlen[l] + 1)
+                sym = l;
+            else
+            {
+                offset -= d.symlen[l] + 1;
+                sym = right(d.btree, sym);
+            }
+        }
+
+        return left(d.btree, sym);
+    }
+
+    static int mapScore(const Table& table, int f, int value, WDL wdl)
+    {
+        if (table.type == WDL_TABLE)
+            return value - 2;
+
+        static const int WDL_MAP[] = { 1, 3, 0, 2, 0 };
+        const Pairs& d = table.get(0, f);
+        if (d.flags & MAPPED)
+        {
+            int i = d.mapIdx[WDL_MAP[wdl + 2]] + value;
+            value = d.flags & WIDE ? readLE16(table.map + 2 * i) : table.map[i];
+        }
+
+        // Stored in moves unless flagged as plies
+        if ((wdl == WIN && !(d.flags & WIN_PLIES))
+            || (wdl == LOSS && !(d.flags & LOSS_PLIES))
+            || wdl == CURSED_WIN || wdl == BLESSED_LOSS)
+            value *= 2;
+
+        return value + 1;
+    }
+
+    // Tables hold the side named first as white, so positions of the other
+    // side are looked up with the colors reversed and the board flipped
+    static int probeTable(const Board& board, const Table& table, WDL wdl, State& state)
+    {
+        int squares[MAX_PIECES] = {};
+        U8 pieces[MAX_PIECES] = {};
+        int size = 0, leadPawnsCnt = 0, tbFile = 0;
+        BB leadPawns = BB(0);
+
+        bool flip = (table.key == table.key2 && board.sideToMove() == BLACK)
+                 || board.getMaterialKey() != table.key;
+        int flipColor = flip ? 8 : 0,
+            flipSquares = flip ? 56 : 0,
+            stm = flip ^ (board.sideToMove() == BLACK);
+
+        // Tables with pawns are split by the file of the leading pawn
+        if (table.hasPawns)
+        {
+            int pc = table.get(0, 0).pieces[0] ^ flipColor;
+            BB b = leadPawns = board.getPieces<PAWN>(pc & 8 ? BLACK : WHITE);
+            while (b)
+            {
+                Square sq = b.lsb();
+                b.clear(sq);
+                squares[size++] = sq ^ flipSquares;
+            }
+            leadPawnsCnt = size;
+
+            std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCnt, pawnsBefore));
+            tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+        }
+
+        if (table.type == DTZ_TABLE
+            && (table.get(stm, tbFile).flags & STM) != stm
+            && (table.key != table.key2 || table.hasPawns))
+        {
+            state = CHANGE_STM;
+            return 0;
+        }
+
+        BB b = board.occupancy() & ~leadPawns;
+        while (b)
+        {
+            Square sq = b.lsb();
+            b.clear(sq);
+            Piece piece = board.getPiece(sq);
+            squares[size] = sq ^ flipSquares;
+            pieces[size++] = U8((Types::getPieceType(piece) | (Types::getPieceColor(piece) == BLACK ? 8 : 0)) ^ flipColor);
+        }
+
+        // Order the pieces like the table
+        const Pairs& d = table.get(stm, tbFile);
+        for (int i = leadPawnsCnt; i < size - 1; i++)
+            for (int j = i + 1; j < size; j++)
+                if (d.pieces[i] == pieces[j])
+                {
+                    std::swap(pieces[i], pieces[j]);
+                    std::swap(squares[i], squares[j]);
+                    break;
+                }
+
+        // The leading piece goes on files a to d
+        if (fileOf(squares[0]) > 3)
+            for (int i = 0; i < size; i++)
+                squares[i] ^= 7;
+
+        U64 idx;
+        if (table.hasPawns)
+        {
+            idx = (U64)leadPawnIdx[leadPawnsCnt][squares[0]];
+            std::stable_sort(squares + 1, squares + leadPawnsCnt, pawnsBefore);
+            for (int i = 1; i < leadPawnsCnt; i++)
+                idx += (U64)binomial[i][mapPawns[squares[i]]];
+        }
+        else
+        {
+            // Without pawns the leading piece also goes on ranks 1 to 4,
+            // and the first piece off the diagonal below it
+            if (rankOf(squares[0]) > 3)
+                for (int i = 0; i < size; i++)
+                    squares[i] ^= 56;
+
+            for (int i = 0; i < d.groupLen[0]; i++)
+            {
+                if (!offDiagonal(squares[i]))
+                    continue;
+
+                if (offDiagonal(squares[i]) > 0)
+                    for (int j = i; j < size; j++)
+                        squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                break;
+            }
+
+            // Three unique pieces are indexed together, otherwise the kings
+            if (table.hasUniquePieces)
+            {
+                int adjust1 = squares[1] > squares[0],
+                    adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+                if (offDiagonal(squares[0]))
+                    idx = U64((mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62
+                              + squares[2] - adjust2);
+                else if (offDiagonal(squares[1]))
+                    idx = U64((6 * 63 + rankOf(squares[0]) * 28 + mapB1H1H7[squares[1]]) * 62
+                              + squares[2] - adjust2);
+                else if (offDiagonal(squares[2]))
+                    idx = U64(6 * 63 * 62 + 4 * 28 * 62
+                              + rankOf(squares[0]) * 7 * 28
+                              + (rankOf(squares[1]) - adjust1) * 28
+                              + mapB1H1H7[squares[2]]);
+                else
+                    idx = U64(6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28
+                              + rankOf(squares[0]) * 7 * 6
+                              + (rankOf(squares[1]) - adjust1) * 6
+                              + (rankOf(squares[2]) - adjust2));
+            }
+            else
+                idx = (U64)mapKK[mapA1D1D4[squares[0]]][squares[1]];
+        }
+        idx *= d.groupIdx[0];
+
+        // The other groups, by their squares in ascending order, skipping
+        // the squares of the groups before them
+        int* groupSq = squares + d.groupLen[0];
+        bool remainingPawns = table.hasPawns && table.pawnCount[1];
+        for (int next = 1; d.groupLen[next]; next++)
+        {
+            std::stable_sort(groupSq, groupSq + d.groupLen[next]);
+            U64 n = 0;
+            for (int i = 0; i < d.groupLen[next]; i++)
+            {
+                int adjust = (int)std::count_if(squares, groupSq, [&](int sq) { return groupSq[i] > sq; });
+                n += (U64)binomial[i + 1][groupSq[i] - adjust - 8 * remainingPawns];
+            }
+            remainingPawns = false;
+            idx += n * d.groupIdx[next];
+            groupSq += d.groupLen[next];
+        }
+
+        return mapScore(table, tbFile, decompress(d, idx), wdl);
+    }
+
+    template<TableType Type>
+    static int probeTable(const Board& board, State& state, WDL wdl = DRAW)
+    {
+        // Two bare kings have no table
+        if (board.occupancy().count() == 2)
+            return Type == WDL_TABLE ? DRAW : 0;
+
+        auto it = byMaterial.find(board.getMaterialKey());
+        const Table* table = it == byMaterial.end() ? nullptr
+                           : Type == WDL_TABLE ? it->second.first : it->second.second;
+        if (!table)
+        {
+            state = FAIL;
+            return 0;
+        }
+        return probeTable(board, *table, wdl, state);
+    }
+
+    /**
+     *  Probing
+     */
+
+    static std::vector<Move> legalMoves(Board& board)
+    {
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+        std::vector<Move> moves;
+        for (auto& move : gen.moves)
+            if (board.isLegalMove(move))
+                moves.push_back(move);
+        return moves;
+    }
+
+    static inline bool isCapture(const Board& board, Move move)
+    {
+        return board.getPiece(move.to()) != EMPTY || move.type() == ENPASSANT;
+    }
+
+    static inline bool isZeroing(const Board& board, Move move)
+    {
+        return isCapture(board, move) || board.getPieceType(move.from()) == PAWN;
+    }
+
+    static inline int sign(int x)
+    {
+        return (x > 0) - (x < 0);
+    }
+
+    static inline bool canProbe(const Board& board)
+    {
+        return !byMaterial.empty()
+            && board.occupancy().count() <= largestTable
+            && !board.canCastle(WHITE) && !board.canCastle(BLACK);
+    }
+
+    // Tables may store any value where a capture wins, or the best of a
+    // draw or a loss where a capture draws, so captures are searched and
+    // the best of their results and the table's is the position's.
+    // The distance to zeroing also needs pawn moves, and tables do not know
+    // of en passant captures, so a zeroing best move is reported for those
+    template<bool Zeroing>
+    static WDL search(Board& board, State& state)
+    {
+        WDL best = LOSS;
+        auto moves = legalMoves(board);
+        size_t searched = 0;
+
+        for (auto& move : moves)
+        {
+            if (!isCapture(board, move) && (!Zeroing || board.getPieceType(move.from()) != PAWN))
+                continue;
+
+            searched++;
+            board.make(move);
+            WDL value = WDL(-search<false>(board, state));
+            board.unmake();
+
+            if (state == FAIL)
+                return DRAW;
+
+            if (value > best)
+            {
+                best = value;
+                if (value >= WIN)
+                {
+                    state = ZEROING;
+                    return value;
+                }
+            }
+        }
+
+        // When every move was searched the table is not needed
+        bool noMoreMoves = searched && searched == moves.size();
+        WDL value = best;
+        if (!noMoreMoves)
+        {
+            value = WDL(probeTable<WDL_TABLE>(board, state));
+            if (state == FAIL)
+                return DRAW;
+        }
+
+        if (best >= value)
+        {
+            state = best > DRAW || noMoreMoves ? ZEROING : OK;
+            return best;
+        }
+
+        state = OK;
+        return value;
+    }
+
+    static int dtzBeforeZeroing(WDL wdl)
+    {
+        return wdl == WIN          ?  1
+             : wdl == CURSED_WIN   ?  101
+             : wdl == BLESSED_LOSS ? -101
+             : wdl == LOSS         ? -1 : 0;
+    }
+
+    static int probeDTZ(Board& board, State& state)
+    {
+        state = OK;
+        WDL wdl = search<true>(board, state);
+        if (state == FAIL || wdl == DRAW)
+            return 0;
+
+        if (state == ZEROING)
+            return dtzBeforeZeroing(wdl);
+
+        int dtz = probeTable<DTZ_TABLE>(board, state, wdl);
+        if (state == FAIL)
+            return 0;
+
+        if (state != CHANGE_STM)
+            return (dtz + 100 * (wdl == BLESSED_LOSS || wdl == CURSED_WIN)) * sign(wdl);
+
+        // The table holds the other side to move, so take the best of the
+        // moves, counting the ply they add
+        int minDTZ = 0xFFFF;
+        for (auto& move : legalMoves(board))
+        {
+            bool zeroing = isZeroing(board, move);
+            board.make(move);
+
+            // A zeroing move counts from before it, and only its result
+            // is needed
+            dtz = zeroing ? -dtzBeforeZeroing(search<false>(board, state))
+                          : -probeDTZ(board, state);
+
+            if (dtz == 1 && board.isCheck() && legalMoves(board).empty())
+                minDTZ = 1;
+
+            if (!zeroing)
+                dtz += sign(dtz);
+
+            if (dtz < minDTZ && sign(dtz) == sign(wdl))
+                minDTZ = dtz;
+
+            board.unmake();
+
+            if (state == FAIL)
+                return 0;
+        }
+
+        // Without legal moves the side to move is mated
+        return minDTZ == 0xFFFF ? -1 : minDTZ;
+    }
+
+    bool probeWDL(Board& board, WDL& wdl)
+    {
+        if (!canProbe(board))
+            return false;
+
+        State state = OK;
+        wdl = search<false>(board, state);
+        return state != FAIL;
+    }
+
+    bool probeDTZ(Board& board, int& dtz)
+    {
+        if (!canProbe(board))
+            return false;
+
+        State state = OK;
+        dtz = probeDTZ(board, state);
+        return state != FAIL;
+    }
+
+    bool rankRootMoves(Board& board, const std::vector<Move>& moves, std::vector<int>& ranks)
+    {
+        if (!canProbe(board) || moves.empty())
+            return false;
+
+        int cnt50 = board.getHmClock();
+        ranks.clear();
+        for (auto& move : moves)
+        {
+            State state = OK;
+            int dtz;
+            board.make(move);
+
+            // The distance to zeroing counted from the root
+            if (board.getHmClock() == 0)
+                dtz = dtzBeforeZeroing(WDL(-search<false>(board, state)));
+            else
+            {
+                dtz = -probeDTZ(board, state);
+                dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+            }
+
+            if (dtz == 2 && board.isCheck() && legalMoves(board).empty())
+                dtz = 1;
+
+            board.unmake();
+
+            if (state == FAIL)
+                return false;
+
+            // Wins within the fifty move rule rank equally, and losses too
+            // unless the rule can save them
+            int rank = dtz > 0 ? (dtz + cnt50 <= 99 ? MAX_DTZ : MAX_DTZ - (dtz + cnt50))
+                     : dtz < 0 ? (-dtz * 2 + cnt50 < 100 ? -MAX_DTZ : -MAX_DTZ + (-dtz + cnt50))
+                     : 0;
+            ranks.push_back(rank);
+        }
+
+        return true;
+    }
+
+    /**
+     *  Loading
+     */
+
+    // Codes name the pieces of each side, such as "KRPvKR"
+    static bool open(Table& table, const std::string& code, const std::string& filename)
+    {
+        size_t v = code.find('v');
+        if (v == std::string::npos || code[0] != 'K' || code.size() > size_t(MAX_PIECES + 1)
+            || code.find_first_not_of("KQRBNPv") != std::string::npos
+            || std::count(code.begin(), code.end(), 'K') != 2 || code[v + 1] != 'K')
+            return false;
+
+        int counts[2][NPIECETYPES] = {};
+        static const std::string letters = "PNBRQK";
+        for (size_t i = 0; i < code.size(); i++)
+            if (i != v)
+                counts[i > v][letters.find(code[i])]++;
+
+        table.key = Material::key(code, WHITE);
+        table.key2 = Material::key(code, BLACK);
+        table.pieceCount = int(code.size() - 1);
+        table.hasPawns = counts[0][0] || counts[1][0];
+        for (int side = 0; side < 2; side++)
+            for (int pt = 0; pt < 5; pt++)
+                table.hasUniquePieces |= counts[side][pt] == 1;
+
+        // The side with fewer pawns leads, for better compression
+        bool whiteLeads = !counts[1][0] || (counts[0][0] && counts[1][0] >= counts[0][0]);
+        table.pawnCount[0] = counts[whiteLeads ? 0 : 1][0];
+        table.pawnCount[1] = counts[whiteLeads ? 1 : 0][0];
+
+        table.file = std::make_unique<MappedFile>(filename);
+        return table.file->isOpen() && parse(table);
+    }
+
+    void clear()
+    {
+        byMaterial.clear();
+        tables.clear();
+        largestTable = 0;
+    }
+
+    int load(const std::string& paths)
+    {
+        clear();
+        init();
+
+        // Find the files of every directory, the first of a name winning
+        std::unordered_map<std::string, std::string> files[2];
+        std::istringstream iss(paths);
+        std::string path;
+        while (std::getline(iss, path, ':'))
+        {
+            std::error_code ec;
+            for (auto& entry : std::filesystem::directory_iterator(path, ec))
+                for (int type = WDL_TABLE; type <= DTZ_TABLE; type++)
+                    if (entry.path().extension() == EXTENSIONS[type])
+                        files[type].emplace(entry.path().stem().string(), entry.path().string());
+        }
+
+        int found = 0;
+        for (auto& file : files[WDL_TABLE])
+        {
+            auto wdl = std::make_unique<Table>();
+            if (!open(*wdl, file.first, file.second))
+                continue;
+
+            // Distance to zeroing tables are only used with their results
+            std::unique_ptr<Table> dtz;
+            auto it = files[DTZ_TABLE].find(file.first);
+            if (it != files[DTZ_TABLE].end())
+            {
+                dtz = std::make_unique<Table>();
+                dtz->type = DTZ_TABLE;
+                if (!open(*dtz, it->first, it->second))
+                    dtz.reset();
+            }
+
+            std::pair<const Table*, const Table*> entry(wdl.get(), dtz.get());
+            byMaterial[wdl->key] = entry;
+            byMaterial[wdl->key2] = entry;
+            largestTable = std::max(largestTable, wdl->pieceCount);
+            found++;
+
+            tables.push_back(std::move(wdl));
+            if (dtz)
+                tables.push_back(std::move(dtz));
+        }
+
+        return found;
+    }
+
+    int largest()
+    {
+        return largestTable;
+    }
+
+}
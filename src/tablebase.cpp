@@ -0,0 +1,951 @@
+#include "tablebase.hpp"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include "globals.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "material.hpp"
+#include "zobrist.hpp"
+#include "mappedfile.hpp"
+
+namespace Tablebase {
+
+    static const char MAGIC[4] = { 'A', 'T', 'B', '2' };
+
+    // Pieces other than kings, from the most valuable
+    static const std::string PIECES = "QRBNP";
+    static const PieceType PIECE_TYPES[5] = { QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
+    static const int PIECE_VALUES[5] = { 9, 5, 3, 3, 1 };
+
+    // Squares of the white king in pawnless tables, all others being
+    // reflections of these
+    static const Square TRIANGLE[10] = { A1, B1, C1, D1, B2, C2, D2, C3, D3, D4 };
+
+    static inline BB bb(Square sq)
+    {
+        return BB(G::SQUARE_BB[sq]);
+    }
+
+    static inline Square transpose(Square sq)
+    {
+        return Square(((sq & 7) << 3) | (sq >> 3));
+    }
+
+    // The pieces of a position and the side to move
+    struct Placement
+    {
+        int n = 0;
+        Color colors[MAX_PIECES];
+        PieceType types[MAX_PIECES];
+        Square squares[MAX_PIECES];
+        Color stm = WHITE;
+
+        BB occupancy() const
+        {
+            BB occ = BB(0);
+            for (int i = 0; i < n; i++)
+                occ = occ | bb(squares[i]);
+            return occ;
+        }
+
+        Square king(Color c) const
+        {
+            for (int i = 0; i < n; i++)
+                if (types[i] == KING && colors[i] == c)
+                    return squares[i];
+            return INVALID;
+        }
+
+        void remove(int k)
+        {
+            for (int i = k; i + 1 < n; i++)
+            {
+                colors[i] = colors[i+1];
+                types[i] = types[i+1];
+                squares[i] = squares[i+1];
+            }
+            n--;
+        }
+
+        U64 materialKey() const
+        {
+            int counts[NCOLORS][NPIECETYPES] = {};
+            U64 key = 0x0;
+            for (int i = 0; i < n; i++)
+                key ^= Zobrist::material[colors[i]][types[i]-1][counts[colors[i]][types[i]-1]++];
+            return key;
+        }
+    };
+
+    static bool isAttacked(const Placement& p, Square target, Color by, BB occ)
+    {
+        for (int i = 0; i < p.n; i++)
+        {
+            if (p.colors[i] != by)
+                continue;
+
+            BB attacks = p.types[i] == PAWN ? MoveGen::attacksByPawns(bb(p.squares[i]), by)
+                                            : MoveGen::movesByPiece(p.squares[i], p.types[i], occ);
+            if (attacks & bb(target))
+                return true;
+        }
+        return false;
+    }
+
+    static inline bool isCheck(const Placement& p)
+    {
+        return isAttacked(p, p.king(p.stm), ~p.stm, p.occupancy());
+    }
+
+    // Calls f with the position after each legal move, whether the move
+    // left the table by a capture or a promotion, and the square a double
+    // push passed over, or INVALID
+    template<typename F>
+    static void forEachMove(const Placement& p, F f)
+    {
+        BB occ = p.occupancy(),
+           own = BB(0);
+        for (int i = 0; i < p.n; i++)
+            if (p.colors[i] == p.stm)
+                own = own | bb(p.squares[i]);
+
+        for (int i = 0; i < p.n; i++)
+        {
+            if (p.colors[i] != p.stm)
+                continue;
+
+            Square from = p.squares[i];
+            BB targets;
+            if (p.types[i] == PAWN)
+            {
+                int up = p.stm == WHITE ? 8 : -8;
+                targets = MoveGen::attacksByPawns(bb(from), p.stm) & (occ & ~own);
+
+                Square push = Square(from + up);
+                if (!(occ & bb(push)))
+                {
+                    targets = targets | bb(push);
+                    int rank = p.stm == WHITE ? Types::getRank(from) : RANK8 - Types::getRank(from);
+                    if (rank == RANK2 && !(occ & bb(Square(push + up))))
+                        targets = targets | bb(Square(push + up));
+                }
+            }
+            else
+                targets = MoveGen::movesByPiece(from, p.types[i], occ) & ~own;
+
+            while (targets)
+            {
+                Square to = targets.lsb();
+                targets.clear(to);
+
+                Placement next = p;
+                next.stm = ~p.stm;
+                next.squares[i] = to;
+                int moved = i;
+                bool converted = false;
+                for (int k = 0; k < next.n; k++)
+                {
+                    if (k != moved && next.squares[k] == to)
+                    {
+                        next.remove(k);
+                        moved -= k < moved;
+                        converted = true;
+                        break;
+                    }
+                }
+
+                if (isAttacked(next, next.king(p.stm), next.stm, next.occupancy()))
+                    continue;
+
+                int rank = Types::getRank(to);
+                if (p.types[i] == PAWN && (rank == RANK8 || rank == RANK1))
+                {
+                    for (PieceType pt : { QUEEN, ROOK, BISHOP, KNIGHT })
+                    {
+                        next.types[moved] = pt;
+                        f(next, true, INVALID);
+                    }
+                }
+                else
+                    f(next, converted, to == Square(from + 16) || to == Square(from - 16)
+                                       ? Square((from + to) / 2) : INVALID);
+            }
+        }
+    }
+
+    // Calls f with the position after each legal en passant capture of the
+    // pawn that just passed over the square ep
+    template<typename F>
+    static void forEachEnPassant(const Placement& p, Square ep, F f)
+    {
+        if (ep == INVALID)
+            return;
+
+        Square victim = Square(p.stm == WHITE ? ep - 8 : ep + 8);
+        int taken = 0;
+        while (taken < p.n && p.squares[taken] != victim)
+            taken++;
+
+        for (int i = 0; i < p.n; i++)
+        {
+            if (p.colors[i] != p.stm || p.types[i] != PAWN
+                || !(MoveGen::attacksByPawns(bb(p.squares[i]), p.stm) & bb(ep)))
+                continue;
+
+            Placement next = p;
+            next.stm = ~p.stm;
+            next.squares[i] = ep;
+            next.remove(taken);
+
+            if (!isAttacked(next, next.king(p.stm), next.stm, next.occupancy()))
+                f(next);
+        }
+    }
+
+    // Calls f with each legal position, with the other side to move, that
+    // has a move to this one which is neither a capture nor a promotion.
+    // A double push is unmade like a single push; the build scores the
+    // positions whose double push can be taken en passant itself
+    template<typename F>
+    static void forEachUnmove(const Placement& p, F f)
+    {
+        Color mover = ~p.stm;
+        BB occ = p.occupancy();
+
+        for (int i = 0; i < p.n; i++)
+        {
+            if (p.colors[i] != mover)
+                continue;
+
+            Square to = p.squares[i];
+            BB origins = BB(0);
+            if (p.types[i] == PAWN)
+            {
+                int down = mover == WHITE ? -8 : 8;
+                int rank = mover == WHITE ? Types::getRank(to) : RANK8 - Types::getRank(to);
+                Square back = Square(to + down);
+                if (rank >= RANK3 && !(occ & bb(back)))
+                {
+                    origins = bb(back);
+                    if (rank == RANK4 && !(occ & bb(Square(back + down))))
+                        origins = origins | bb(Square(back + down));
+                }
+            }
+            else
+                origins = MoveGen::movesByPiece(to, p.types[i], occ) & ~occ;
+
+            while (origins)
+            {
+                Square from = origins.lsb();
+                origins.clear(from);
+
+                Placement prev = p;
+                prev.squares[i] = from;
+                prev.stm = mover;
+                if (!isAttacked(prev, prev.king(p.stm), mover, prev.occupancy()))
+                    f(prev);
+            }
+        }
+    }
+
+    /**
+     *  Tables
+     */
+
+    class Table
+    {
+    public:
+
+        explicit Table(const std::string& name)
+        : code(name)
+        {
+            size_t weak = code.find('K', 1);
+            for (size_t i = 0; i < code.size(); i++)
+            {
+                colors[n] = i < weak ? WHITE : BLACK;
+                types[n] = code[i] == 'K' ? KING : PIECE_TYPES[PIECES.find(code[i])];
+                pawns |= types[n] == PAWN;
+                n++;
+            }
+
+            size = pawns ? 32 : 10;
+            for (int i = 1; i < n; i++)
+                size *= 64;
+        }
+
+        std::string code;
+        int n = 0;
+        Color colors[MAX_PIECES];
+        PieceType types[MAX_PIECES];
+        bool pawns = false;
+        U64 size;       // Positions for each side to move
+
+        const U8* values = nullptr;
+        std::unique_ptr<MappedFile> file;
+
+        // The index of a position with the table's material, the same for
+        // all of its reflections
+        U64 index(const Placement& p) const
+        {
+            Square sq[MAX_PIECES] = {};
+            bool used[MAX_PIECES] = {};
+            for (int s = 0; s < n; s++)
+            {
+                for (int i = 0; i < p.n; i++)
+                {
+                    if (!used[i] && p.colors[i] == colors[s] && p.types[i] == types[s])
+                    {
+                        used[i] = true;
+                        sq[s] = p.squares[i];
+                        break;
+                    }
+                }
+            }
+
+            // Move the white king to files a to d, and to the a1-d1-d4
+            // triangle if pawns do not fix the ranks
+            int flip = 0;
+            if (Types::getFile(sq[0]) > FILE4)
+                flip ^= 7;
+            if (!pawns && Types::getRank(sq[0]) > RANK4)
+                flip ^= 56;
+            for (int s = 0; s < n; s++)
+                sq[s] = Square(sq[s] ^ flip);
+
+            if (!pawns && (int)Types::getRank(sq[0]) > (int)Types::getFile(sq[0]))
+                for (int s = 0; s < n; s++)
+                    sq[s] = transpose(sq[s]);
+
+            U64 i = encode(sq);
+
+            // On the diagonal, the position and its transposition are the same
+            if (!pawns && (int)Types::getRank(sq[0]) == (int)Types::getFile(sq[0]))
+            {
+                for (int s = 0; s < n; s++)
+                    sq[s] = transpose(sq[s]);
+                i = std::min(i, encode(sq));
+            }
+
+            return p.stm == WHITE ? i : i + size;
+        }
+
+        Placement decode(U64 i) const
+        {
+            Placement p;
+            p.n = n;
+            p.stm = i < size ? WHITE : BLACK;
+            i %= size;
+
+            for (int s = n - 1; s > 0; s--)
+            {
+                p.squares[s] = Square(i % 64);
+                i /= 64;
+            }
+            p.squares[0] = pawns ? Types::getSquare(File(i % 4), Rank(i / 4)) : TRIANGLE[i];
+
+            for (int s = 0; s < n; s++)
+            {
+                p.colors[s] = colors[s];
+                p.types[s] = types[s];
+            }
+            return p;
+        }
+
+    private:
+
+        // Like pieces are interchangeable, so their squares are sorted
+        U64 encode(Square* sq) const
+        {
+            Square sorted[MAX_PIECES] = {};
+            for (int s = 0; s < n; s++)
+                sorted[s] = sq[s];
+            for (int s = 1; s < n; s++)
+                for (int t = s; t > 1 && colors[t] == colors[t-1] && types[t] == types[t-1]
+                                       && sorted[t] < sorted[t-1]; t--)
+                    std::swap(sorted[t], sorted[t-1]);
+
+            U64 i = pawns ? U64(Types::getRank(sorted[0]) * 4 + Types::getFile(sorted[0]))
+                          : U64(std::find(TRIANGLE, TRIANGLE + 10, sorted[0]) - TRIANGLE);
+            for (int s = 1; s < n; s++)
+                i = i * 64 + sorted[s];
+            return i;
+        }
+
+    };
+
+    // Loaded tables by material key, and whether their colors are reversed
+    static std::vector<std::unique_ptr<Table>> tables;
+    static std::unordered_map<U64, std::pair<const Table*, bool>> byMaterial;
+    static int largestTable = 0;
+
+    static bool lookup(Placement p, U8& value)
+    {
+        auto it = byMaterial.find(p.materialKey());
+        if (it == byMaterial.end())
+            return false;
+
+        const Table* table = it->second.first;
+        if (it->second.second)
+        {
+            for (int i = 0; i < p.n; i++)
+            {
+                p.colors[i] = ~p.colors[i];
+                p.squares[i] = Square(p.squares[i] ^ 56);
+            }
+            p.stm = ~p.stm;
+        }
+
+        value = table->values[table->index(p)];
+        return true;
+    }
+
+    // Map a table file after checking its header
+    static bool open(const std::string& filename)
+    {
+        auto file = std::make_unique<MappedFile>(filename);
+        if (!file->isOpen() || file->size() < sizeof(Header))
+            return false;
+
+        Header header;
+        std::memcpy(&header, file->data(), sizeof(Header));
+        std::string code(header.code, strnlen(header.code, sizeof(header.code)));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || normalize(code) != code)
+            return false;
+
+        auto table = std::make_unique<Table>(code);
+        if (header.size != 2 * table->size || file->size() != sizeof(Header) + header.size)
+            return false;
+
+        table->values = reinterpret_cast<const U8*>(file->data() + sizeof(Header));
+        table->file = std::move(file);
+
+        byMaterial.emplace(Material::key(code, WHITE), std::make_pair(table.get(), false));
+        byMaterial.emplace(Material::key(code, BLACK), std::make_pair(table.get(), true));
+        largestTable = std::max(largestTable, table->n);
+        tables.push_back(std::move(table));
+        return true;
+    }
+
+    void clear()
+    {
+        byMaterial.clear();
+        tables.clear();
+        largestTable = 0;
+    }
+
+    int load(const std::string& path)
+    {
+        clear();
+
+        std::error_code ec;
+        for (auto& entry : std::filesystem::directory_iterator(path, ec))
+            if (entry.path().extension() == EXTENSION)
+                open(entry.path().string());
+
+        return (int)tables.size();
+    }
+
+    int largest()
+    {
+        return largestTable;
+    }
+
+    /**
+     *  Generation
+     */
+
+    // Results while generating, with distances to mate in plies
+    enum : U16 {
+        UNKNOWN = 0,
+        ILLEGAL = 1,
+        DRAW    = 2,
+        WIN     = 0x4000,
+        LOSS    = 0x8000,
+        DTM     = 0x0fff
+    };
+
+    static inline U16 fromByte(U8 value)
+    {
+        if (!value)
+            return DRAW;
+        return value < 128 ? U16(WIN | (2 * value - 1)) : U16(LOSS | (2 * (value - 128)));
+    }
+
+    static inline U8 toByte(U16 result)
+    {
+        if (result & WIN)
+            return (U8)std::min(127, ((result & DTM) + 1) / 2);
+        if (result & LOSS)
+            return (U8)(128 + std::min(127, (result & DTM) / 2));
+        return 0;
+    }
+
+    template<typename F>
+    static void parallelFor(U64 n, unsigned nThreads, F f)
+    {
+        const U64 BLOCK = 4096;
+        std::atomic<U64> next(0);
+        auto worker = [&]()
+        {
+            for (U64 begin = next.fetch_add(BLOCK); begin < n; begin = next.fetch_add(BLOCK))
+                for (U64 i = begin; i < std::min(n, begin + BLOCK); i++)
+                    f(i);
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < nThreads; t++)
+            workers.emplace_back(worker);
+        worker();
+        for (auto& thread : workers)
+            thread.join();
+    }
+
+    // Positions with overlapping pieces, pawns on the back ranks, the side
+    // not to move in check, or that are a reflection of another index are
+    // left out
+    static bool isValid(const Table& table, const Placement& p, U64 i)
+    {
+        BB occ = p.occupancy();
+        if (occ.count() != p.n)
+            return false;
+
+        for (int s = 0; s < p.n; s++)
+            if (p.types[s] == PAWN && (Types::getRank(p.squares[s]) == RANK1 || Types::getRank(p.squares[s]) == RANK8))
+                return false;
+
+        return table.index(p) == i && !isAttacked(p, p.king(~p.stm), p.stm, occ);
+    }
+
+    /**
+     *  Retrograde analysis, by layers of distance to mate
+     *  Moves out of the table are scored from the tables they lead to.
+     *  Then, from the positions a layer away from mate, each position
+     *  with a move to a loss is a win one ply further, and each with all
+     *  of its moves to wins a loss, as far from mate as its longest win.
+     *  Positions with a double push that can be taken en passant lead out
+     *  of the table, so they are scored from all of their moves at each
+     *  layer instead of from their unmoves
+     */
+    static std::vector<U8> build(const Table& table, unsigned nThreads)
+    {
+        U64 n = 2 * table.size;
+        std::vector<std::atomic<U16>> results(n);
+        std::vector<U16> conversions(n);
+        std::vector<U8> enPassant(n);
+        std::atomic<int> maxDtm(0);
+
+        auto raise = [&](int dtm)
+        {
+            int m = maxDtm;
+            while (dtm > m && !maxDtm.compare_exchange_weak(m, dtm));
+        };
+
+        parallelFor(n, nThreads, [&](U64 i)
+        {
+            Placement p = table.decode(i);
+            if (!isValid(table, p, i))
+            {
+                results[i] = ILLEGAL;
+                return;
+            }
+
+            int moves = 0,
+                inTable = 0,
+                win = 0,
+                loss = 0;
+            bool draw = false;
+            forEachMove(p, [&](const Placement& next, bool converted, Square ep)
+            {
+                moves++;
+                forEachEnPassant(next, ep, [&](const Placement& after)
+                {
+                    U8 value = 0;
+                    lookup(after, value);
+                    enPassant[i] = 1;
+                    raise((fromByte(value) & DTM) + 2);
+                });
+
+                if (!converted)
+                {
+                    inTable++;
+                    return;
+                }
+
+                U8 value = 0;
+                lookup(next, value);
+                U16 result = fromByte(value);
+                int dtm = (result & DTM) + 1;
+                if (result & LOSS)
+                    win = win ? std::min(win, dtm) : dtm;
+                else if (result & WIN)
+                    loss = std::max(loss, dtm);
+                else
+                    draw = true;
+            });
+
+            if (!moves)
+            {
+                results[i] = isCheck(p) ? LOSS : DRAW;
+                return;
+            }
+
+            conversions[i] = win ? U16(WIN | win) : draw ? U16(DRAW) : loss ? U16(LOSS | loss) : U16(0);
+            raise(win);
+            if (!inTable && !win)
+            {
+                results[i] = draw ? U16(DRAW) : U16(LOSS | loss);
+                raise(loss);
+            }
+        });
+
+        // The distance to mate of a position whose moves in the table all
+        // lead to wins, or -1
+        auto lossDepth = [&](const Placement& p, U16 conversion)
+        {
+            int dtm = conversion & LOSS ? conversion & DTM : 0;
+            bool lost = true;
+            forEachMove(p, [&](const Placement& next, bool converted, Square)
+            {
+                if (converted || !lost)
+                    return;
+
+                U16 result = results[table.index(next)];
+                if (result & WIN)
+                    dtm = std::max(dtm, (result & DTM) + 1);
+                else
+                    lost = false;
+            });
+            return lost ? dtm : -1;
+        };
+
+        // The result of a position from all of its moves, where the opponent
+        // may answer a double push in the table or by taking it en passant,
+        // or UNKNOWN while it depends on results further than d from mate
+        auto forwardResult = [&](const Placement& p, U16 conversion, int d)
+        {
+            int win = conversion & WIN ? conversion & DTM : 0,
+                loss = conversion & LOSS ? conversion & DTM : 0;
+            bool lost = !(conversion & WIN) && conversion != DRAW;
+            forEachMove(p, [&](const Placement& next, bool converted, Square ep)
+            {
+                if (converted)
+                    return;
+
+                // The opponent's fastest win and slowest loss
+                U16 result = results[table.index(next)];
+                int oppWin = result & WIN ? result & DTM : 0,
+                    oppLoss = result & DTM;
+                bool oppLost = result & LOSS;
+                forEachEnPassant(next, ep, [&](const Placement& after)
+                {
+                    U8 value = 0;
+                    lookup(after, value);
+                    U16 capture = fromByte(value);
+                    int dtm = (capture & DTM) + 1;
+                    if (capture & LOSS)
+                        oppWin = oppWin ? std::min(oppWin, dtm) : dtm;
+                    if (capture & WIN)
+                        oppLoss = std::max(oppLoss, dtm);
+                    else
+                        oppLost = false;
+                });
+
+                // Unknown positions are wins further than d from mate, if any
+                if (oppLost)
+                    win = win ? std::min(win, oppLoss + 1) : oppLoss + 1;
+                if (oppWin && (result != UNKNOWN || oppWin <= d))
+                    loss = std::max(loss, oppWin + 1);
+                else
+                    lost = false;
+            });
+
+            return win && win <= d ? U16(WIN | win) : lost ? U16(LOSS | loss) : U16(UNKNOWN);
+        };
+
+        for (int d = 0; d <= maxDtm; d++)
+        {
+            // Wins out of the table stand unless one in it is faster
+            parallelFor(n, nThreads, [&](U64 i)
+            {
+                if (results[i] == UNKNOWN && conversions[i] == (WIN | d))
+                    results[i] = U16(WIN | d);
+            });
+
+            parallelFor(n, nThreads, [&](U64 i)
+            {
+                if (!enPassant[i] || results[i] != UNKNOWN)
+                    return;
+
+                U16 result = forwardResult(table.decode(i), conversions[i], d);
+                if (result != UNKNOWN)
+                {
+                    results[i] = result;
+                    raise(result & DTM);
+                }
+            });
+
+            parallelFor(n, nThreads, [&](U64 i)
+            {
+                U16 result = results[i];
+                if (!(result & (WIN | LOSS)) || (result & DTM) != d)
+                    return;
+
+                forEachUnmove(table.decode(i), [&](const Placement& prev)
+                {
+                    U64 j = table.index(prev);
+                    U16 expected = UNKNOWN;
+                    if (enPassant[j] || results[j] != UNKNOWN)
+                        return;
+
+                    if (result & LOSS)
+                    {
+                        if (results[j].compare_exchange_strong(expected, U16(WIN | (d + 1))))
+                            raise(d + 1);
+                    }
+                    else if (!(conversions[j] & WIN) && conversions[j] != DRAW)
+                    {
+                        int dtm = lossDepth(prev, conversions[j]);
+                        if (dtm >= 0 && results[j].compare_exchange_strong(expected, U16(LOSS | dtm)))
+                            raise(dtm);
+                    }
+                });
+            });
+        }
+
+        std::vector<U8> values(n);
+        for (U64 i = 0; i < n; i++)
+            values[i] = toByte(results[i]);
+        return values;
+    }
+
+    static bool isValidCode(const std::string& code)
+    {
+        if (code.size() < 2 || code.size() > MAX_PIECES || code[0] != 'K')
+            return false;
+
+        size_t weak = code.find('K', 1);
+        if (weak == std::string::npos || code.find('K', weak + 1) != std::string::npos)
+            return false;
+
+        for (char c : code)
+            if (c != 'K' && PIECES.find(c) == std::string::npos)
+                return false;
+        return true;
+    }
+
+    std::string normalize(const std::string& code)
+    {
+        size_t weak = code.find('K', 1);
+        std::string sides[2] = { code.substr(1, weak - 1), code.substr(weak + 1) };
+        int values[2] = {};
+        for (int s = 0; s < 2; s++)
+        {
+            std::sort(sides[s].begin(), sides[s].end(), [](char a, char b)
+            {
+                return PIECES.find(a) < PIECES.find(b);
+            });
+            for (char c : sides[s])
+                values[s] += PIECE_VALUES[PIECES.find(c)];
+        }
+
+        // The side with more material, or with the more valuable pieces
+        auto order = [](const std::string& side)
+        {
+            std::string indices;
+            for (char c : side)
+                indices += char('0' + PIECES.find(c));
+            return indices;
+        };
+        if (values[1] > values[0] || (values[1] == values[0] && order(sides[1]) < order(sides[0])))
+            std::swap(sides[0], sides[1]);
+
+        return "K" + sides[0] + "K" + sides[1];
+    }
+
+    VecStr combinations(int pieces)
+    {
+        // Each side's pieces, as strings in the order of PIECES
+        std::vector<std::string> sides = { "" };
+        for (size_t i = 0; i < sides.size(); i++)
+        {
+            if ((int)sides[i].size() + 2 >= pieces)
+                continue;
+
+            size_t first = sides[i].empty() ? 0 : PIECES.find(sides[i].back());
+            for (size_t p = first; p < PIECES.size(); p++)
+                sides.push_back(sides[i] + PIECES[p]);
+        }
+
+        VecStr codes;
+        for (auto& white : sides)
+            for (auto& black : sides)
+                if ((int)(white.size() + black.size()) + 2 <= pieces)
+                    codes.push_back(normalize("K" + white + "K" + black));
+
+        std::sort(codes.begin(), codes.end(), [](const std::string& a, const std::string& b)
+        {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        });
+        codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+        return codes;
+    }
+
+    // The tables reached from one by a capture or a promotion
+    static VecStr successors(const std::string& code)
+    {
+        VecStr codes;
+        for (size_t i = 1; i < code.size(); i++)
+        {
+            if (code[i] == 'K')
+                continue;
+
+            codes.push_back(normalize(code.substr(0, i) + code.substr(i + 1)));
+            if (code[i] == 'P')
+                for (char promotion : std::string("QRBN"))
+                    codes.push_back(normalize(code.substr(0, i) + promotion + code.substr(i + 1)));
+        }
+        return codes;
+    }
+
+    bool generate(const std::string& code, const std::string& path, unsigned nThreads)
+    {
+        if (!isValidCode(code))
+            return false;
+
+        std::string name = normalize(code);
+        std::string filename = path + "/" + name + EXTENSION;
+        for (auto& table : tables)
+            if (table->code == name)
+                return true;
+        if (open(filename))
+            return true;
+
+        for (auto& successor : successors(name))
+            if (!generate(successor, path, nThreads))
+                return false;
+
+        auto start = std::chrono::steady_clock::now();
+        Table table(name);
+        std::vector<U8> values = build(table, nThreads);
+
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.pieces = (U8)table.n;
+        std::memcpy(header.code, name.data(), name.size());
+        header.size = values.size();
+
+        std::ofstream ofs(filename, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(values.data()), (std::streamsize)values.size());
+        ofs.close();
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << name << " " << values.size() << " positions "
+                  << elapsed << "s" << std::endl;
+
+        return open(filename);
+    }
+
+    bool probe(const Board& board, int& score, int ply)
+    {
+        if (byMaterial.empty()
+            || (int)board.occupancy().count() > largestTable
+            || board.canCastle(WHITE) || board.canCastle(BLACK)
+            || board.getEnPassant() != INVALID)
+            return false;
+
+        Placement p;
+        p.stm = board.sideToMove();
+        BB occ = board.occupancy();
+        while (occ)
+        {
+            Square sq = occ.lsb();
+            occ.clear(sq);
+            p.colors[p.n] = Types::getPieceColor(board.getPiece(sq));
+            p.types[p.n] = board.getPieceType(sq);
+            p.squares[p.n] = sq;
+            p.n++;
+        }
+
+        U8 value;
+        if (!lookup(p, value))
+            return false;
+
+        U16 result = fromByte(value);
+        if (result & WIN)
+            score = MATESCORE - ply - (result & DTM);
+        else if (result & LOSS)
+            score = -MATESCORE + ply + (result & DTM);
+        else
+            score = DRAWSCORE;
+        return true;
+    }
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--tables")
+                options.tables = G::split(value, ',');
+            else if (flag == "--pieces")
+                options.pieces = std::min(MAX_PIECES, std::stoi(value));
+            else if (flag == "--path")
+                options.path = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else
+                continue;
+
+            i++;
+        }
+
+        return options;
+    }
+
+    int main(const VecStr& args)
+    {
+        Options options = parseArgs(args);
+        VecStr codes = options.tables;
+        for (auto& code : combinations(options.pieces))
+            codes.push_back(code);
+
+        if (args.size() < 2 || args.at(1) != "generate" || codes.empty())
+        {
+            std::cerr << "Usage: Antonius tablebase generate [--tables KQKR,...] [--pieces N]"
+                      << " [--path <dir>] [--threads N]" << std::endl;
+            return 1;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(options.path, ec);
+        load(options.path);
+
+        for (auto& code : codes)
+        {
+            if (!generate(code, options.path, options.threads))
+            {
+                std::cerr << "invalid table " << code << std::endl;
+                return 1;
+            }
+        }
+
+        std::cerr << tables.size() << " tables in " << options.path << std::endl;
+        return 0;
+    }
+
+}
@@ -4,7 +4,7 @@
 
 namespace TT {
 
-    void Table::init(U32 nbytes)
+    void Table::init(size_t nbytes)
     {
         // Clear existing table
         delete [] _table;
@@ -21,30 +21,38 @@ namespace TT {
             std::cerr << e.what() << std::endl;
             exit(EXIT_FAILURE);
         }
+
+        clear();
+    }
+
+    void Table::clear()
+    {
+        for (size_t i = 0; i < _size * 2; i++)
+            _table[i] = Entry();
     }
 
-    void Table::save(U64 zkey, U8 depth, int score, NodeType flags, Move best)
+    void Table::save(U64 zkey, U8 depth, int score, NodeType flags, Move best, int eval)
     {
-        int alwaysReplaceIx = zkey % _size;
-        int depthPreferredIx = alwaysReplaceIx + 1;
+        size_t alwaysReplaceIx = zkey % _size;
+        size_t depthPreferredIx = alwaysReplaceIx + 1;
 
         Entry* entry = &_table[depthPreferredIx];
         if (depth >= entry->depth)
         {
             // Replace entry if depth is higher than previous entry
-            *entry = Entry(zkey, score, depth, flags, best);
+            *entry = Entry(zkey, score, depth, flags, best, eval);
         }
         else
         {
             // Otherwise, always replace
-            _table[alwaysReplaceIx] = Entry(zkey, score, depth, flags, best);
+            _table[alwaysReplaceIx] = Entry(zkey, score, depth, flags, best, eval);
         }
     }
 
     Entry * Table::probe(U64 zkey) const
     {
-        int alwaysReplaceIx = zkey % _size;
-        int depthPreferredIx = alwaysReplaceIx + 1;
+        size_t alwaysReplaceIx = zkey % _size;
+        size_t depthPreferredIx = alwaysReplaceIx + 1;
 
         // Check the always replace entry first
         Entry* entry = &_table[alwaysReplaceIx];
@@ -75,6 +83,7 @@ namespace TT {
         os << "Depth\t" << (int)e.depth << std::endl;
         os << "Flag\t" << e.flag << std::endl;
         os << "Best\t" << e.best << std::endl;
+        os << "Eval\t" << e.eval << std::endl;
         return os;
     }
 
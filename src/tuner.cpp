@@ -0,0 +1,738 @@
+#include "tuner.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include "board.hpp"
+#include "eval.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+#include "mappedfile.hpp"
+#include "endgame.hpp"
+
+namespace Tuner {
+
+    Params defaults()
+    {
+        Params params(NPARAMS, 0);
+
+        for (unsigned phase = OPENING; phase <= ENDGAME; phase++)
+        {
+            for (unsigned piece = 0; piece < 6; piece++)
+                params[MOBILITY + 6*phase + piece] = Eval::MobilityScaling[phase][piece];
+
+            params[PASSED_PAWN + phase]    = Eval::PassedPawnBonus[phase];
+            params[DOUBLE_PAWN + phase]    = Eval::DoublePawnPenalty[phase];
+            params[TRIPLE_PAWN + phase]    = Eval::TriplePawnPenalty[phase];
+            params[ISO_PAWN + phase]       = Eval::IsoPawnPenalty[phase];
+            params[OPEN_FILE + phase]      = Eval::OpenFileBonus[phase];
+            params[HALF_OPEN_FILE + phase] = Eval::HalfOpenFileBonus[phase];
+            params[BISHOP_PAIR + phase]    = Eval::BishopPairBonus[phase];
+        }
+
+        params[TEMPO]              = Eval::TEMPO_BONUS;
+        params[KNIGHT_PAWN]        = Eval::KNIGHT_PENALTY_PER_PAWN;
+        params[ROOK_PAWN]          = Eval::ROOK_BONUS_PER_PAWN;
+        params[CONNECTED_ROOK]     = Eval::CONNECTED_ROOK_BONUS;
+        params[ROOK_ON_SEVENTH]    = Eval::ROOK_ON_SEVENTH_BONUS;
+        params[BACK_RANK_MINOR]    = Eval::BACK_RANK_MINOR_PENALTY;
+        params[MINOR_OUTPOST]      = Eval::MINOR_OUTPOST_BONUS;
+        params[STRONG_KING_SHIELD] = Eval::STRONG_KING_SHIELD_BONUS;
+        params[WEAK_KING_SHIELD]   = Eval::WEAK_KING_SHIELD_BONUS;
+        params[KING_ATTACK]        = Eval::KING_ATTACK_SCALE;
+
+        for (unsigned piece = 0; piece < 5; piece++)
+            params[PIECE_VALUE + piece] = Eval::PieceValues[piece][WHITE];
+
+        for (unsigned distance = 0; distance < 8; distance++)
+        {
+            params[KNIGHT_TROPISM + distance] = Eval::KNIGHT_TROPISM[distance];
+            params[BISHOP_TROPISM + distance] = Eval::BISHOP_TROPISM[distance];
+            params[ROOK_TROPISM + distance]   = Eval::ROOK_TROPISM[distance];
+            params[QUEEN_TROPISM + distance]  = Eval::QUEEN_TROPISM[distance];
+        }
+
+        for (unsigned piece = 0; piece < 6; piece++)
+            for (unsigned phase = OPENING; phase <= ENDGAME; phase++)
+                for (unsigned sq = 0; sq < 64; sq++)
+                    params[PIECE_SQUARE + 128*piece + 64*phase + sq] = Eval::PieceSqValues[piece][phase][sq];
+
+        return params;
+    }
+
+    /**
+     *  Feature extraction, which must follow Board::eval term for term
+     *  The tuner tests check that the two agree on the default parameters
+     */
+
+    static inline void add(std::vector<Feature>& features, int param, double coef)
+    {
+        if (coef != 0)
+            features.push_back({ (U16)param, NO_PARAM, (float)coef });
+    }
+
+    static inline void addTapered(std::vector<Feature>& features, int op, int eg, double coef)
+    {
+        if (coef != 0)
+            features.push_back({ (U16)op, (U16)eg, (float)coef });
+    }
+
+    template<PieceType pt>
+    static void extractMobility(const Board& board, std::vector<Feature>& features)
+    {
+        BB occ = board.occupancy();
+        int moves = MoveGen::mobility<pt>(board.getPieces<pt>(WHITE), ~board.getPieces<ALL>(WHITE), occ)
+                  - MoveGen::mobility<pt>(board.getPieces<pt>(BLACK), ~board.getPieces<ALL>(BLACK), occ);
+        addTapered(features, MOBILITY + pt-1, MOBILITY + 6 + pt-1, moves);
+    }
+
+    template<PieceType pt>
+    static void addAttacks(const Board& board, Color c, Eval::Attacks& attacks)
+    {
+        BB occ = board.occupancy();
+        BB pieces = board.getPieces<pt>(c);
+        while (pieces)
+        {
+            Square sq = pieces.lsb();
+            pieces.clear(sq);
+            attacks.add(c, pt, MoveGen::movesByPiece<pt>(sq, occ));
+        }
+    }
+
+    // The attack maps of both sides, as eval builds them
+    static Eval::Attacks attackMaps(const Board& board)
+    {
+        Eval::Attacks attacks;
+        for (Color c : { WHITE, BLACK })
+            attacks.kingZone[c] = BB(G::KING_ATTACKS[board.getKingSq(c)]) | board.getKingSq(c);
+
+        for (Color c : { WHITE, BLACK })
+        {
+            attacks.add(c, PAWN, MoveGen::attacksByPawns(board.getPieces<PAWN>(c), c));
+            attacks.add(c, KING, BB(G::KING_ATTACKS[board.getKingSq(c)]));
+            addAttacks<KNIGHT>(board, c, attacks);
+            addAttacks<BISHOP>(board, c, attacks);
+            addAttacks<ROOK  >(board, c, attacks);
+            addAttacks<QUEEN >(board, c, attacks);
+        }
+        return attacks;
+    }
+
+    // Tropism, back rank and outpost terms of a color's minor pieces
+    template<PieceType pt>
+    static void extractMinors(const Board& board, Color c, BB allOutposts,
+                              double openingModifier, std::vector<Feature>& features)
+    {
+        int sign = c == WHITE ? 1 : -1;
+        int tropism = pt == KNIGHT ? KNIGHT_TROPISM : BISHOP_TROPISM;
+        Square king = board.getKingSq(~c);
+        BB occ = board.occupancy();
+        BB pieces = board.getPieces<pt>(c);
+
+        while (pieces)
+        {
+            Square sq = pieces.lsb();
+            pieces.clear(sq);
+            add(features, tropism + G::DISTANCE[king][sq], sign);
+            if (Types::getRank(sq) == (c == WHITE ? RANK1 : RANK8))
+                add(features, BACK_RANK_MINOR, sign * openingModifier);
+            BB validOutposts = MoveGen::movesByPiece<pt>(sq, occ) | sq;
+            if (validOutposts & allOutposts)
+                add(features, MINOR_OUTPOST, sign);
+        }
+    }
+
+    void extract(const Board& board, std::vector<Feature>& features)
+    {
+        size_t begin = features.size();
+
+        int opPhase = board.calculatePhase();
+        double openingModifier = opPhase / static_cast<double>(TOTALPHASE);
+
+        // Material and piece square values
+        for (unsigned sq = 0; sq < 64; sq++)
+        {
+            Piece piece = board.getPiece((Square)sq);
+            if (piece == EMPTY)
+                continue;
+
+            Color c = Types::getPieceColor(piece);
+            PieceType pt = Types::getPieceType(piece);
+            int sign = c == WHITE ? 1 : -1;
+            int psq = PIECE_SQUARE + 128*(pt-1) + Eval::ColorSq[c][sq];
+
+            if (pt != KING)
+                add(features, PIECE_VALUE + pt-1, sign);
+            addTapered(features, psq, psq + 64, sign);
+        }
+
+        // Pawn structure
+        BB wPawns = board.getPieces<PAWN>(WHITE),
+           bPawns = board.getPieces<PAWN>(BLACK),
+           allPawns = wPawns | bPawns;
+
+        BB wPassedPawns = wPawns & ~bPawns.getAllFrontSpan<BLACK>(),
+           bPassedPawns = bPawns & ~wPawns.getAllFrontSpan<WHITE>();
+        addTapered(features, PASSED_PAWN, PASSED_PAWN + 1, wPassedPawns.count() - bPassedPawns.count());
+
+        BB wPawnsAhead  = wPawns & ~wPawns.getFrontSpan<WHITE>(),
+           wPawnsBehind = wPawns & ~wPawns.getBackSpan< WHITE>(),
+           wTriplePawns = wPawnsAhead & wPawnsBehind,
+           wDoublePawns = (wPawnsAhead | wPawnsBehind) ^ wTriplePawns;
+        BB bPawnsAhead  = bPawns & ~bPawns.getFrontSpan<BLACK>(),
+           bPawnsBehind = bPawns & ~bPawns.getBackSpan< BLACK>(),
+           bTriplePawns = bPawnsAhead & bPawnsBehind,
+           bDoublePawns = (bPawnsAhead | bPawnsBehind) ^ bTriplePawns;
+        addTapered(features, DOUBLE_PAWN, DOUBLE_PAWN + 1, wDoublePawns.count() - bDoublePawns.count());
+        addTapered(features, TRIPLE_PAWN, TRIPLE_PAWN + 1, wTriplePawns.count() - bTriplePawns.count());
+
+        BB wIsolatedPawns = (wPawns & ~wPawns.getWestFill()) & (wPawns & ~wPawns.getEastFill());
+        BB bIsolatedPawns = (bPawns & ~bPawns.getWestFill()) & (bPawns & ~bPawns.getEastFill());
+        addTapered(features, ISO_PAWN, ISO_PAWN + 1, wIsolatedPawns.count() - bIsolatedPawns.count());
+
+        // Open files, and pawns captured
+        BB openFiles = ~allPawns.getFill(),
+           wHalfOpenFiles = ~wPawns.getFill() ^ openFiles,
+           bHalfOpenFiles = ~bPawns.getFill() ^ openFiles,
+           wSliders = board.straightSliders(WHITE),
+           bSliders = board.straightSliders(BLACK);
+        addTapered(features, OPEN_FILE, OPEN_FILE + 1,
+                   (wSliders & openFiles).count() - (bSliders & openFiles).count());
+        addTapered(features, HALF_OPEN_FILE, HALF_OPEN_FILE + 1,
+                   (wSliders & wHalfOpenFiles).count() - (bSliders & bHalfOpenFiles).count());
+
+        int capturedPawns = 16 - allPawns.count();
+        add(features, KNIGHT_PAWN, (board.count<KNIGHT>(WHITE) - board.count<KNIGHT>(BLACK)) * capturedPawns);
+        add(features, ROOK_PAWN, (board.count<ROOK>(WHITE) - board.count<ROOK>(BLACK)) * capturedPawns);
+
+        // Pieces
+        Square wking = board.getKingSq(WHITE),
+               bking = board.getKingSq(BLACK);
+        BB occ = board.occupancy();
+
+        BB wHoles = ~wPawns.getFrontAttackSpan<WHITE>() & G::WHITEHOLES,
+           bHoles = ~bPawns.getFrontAttackSpan<BLACK>() & G::BLACKHOLES,
+           allOutposts = (bHoles & MoveGen::attacksByPawns<WHITE>(wPawns))
+                       | (wHoles & MoveGen::attacksByPawns<BLACK>(bPawns));
+
+        for (Color c : { WHITE, BLACK })
+        {
+            int sign = c == WHITE ? 1 : -1;
+            Square king = c == WHITE ? wking : bking,
+                   enemyKing = c == WHITE ? bking : wking;
+
+            extractMinors<KNIGHT>(board, c, allOutposts, openingModifier, features);
+
+            if (board.count<BISHOP>(c) >= 2)
+                addTapered(features, BISHOP_PAIR, BISHOP_PAIR + 1, sign);
+            extractMinors<BISHOP>(board, c, allOutposts, openingModifier, features);
+
+            BB pieces = board.getPieces<ROOK>(c);
+            while (pieces)
+            {
+                Square sq = pieces.advanced(c);
+                pieces.clear(sq);
+                add(features, ROOK_TROPISM + G::DISTANCE[enemyKing][sq], sign);
+                add(features, ROOK_TROPISM + G::DISTANCE[king][sq], sign * openingModifier);
+                if (c == WHITE ? Types::getRank(sq) >= RANK7 : Types::getRank(sq) <= RANK2)
+                    add(features, ROOK_ON_SEVENTH, sign * openingModifier);
+                if (MoveGen::movesByPiece<ROOK>(sq, occ) & pieces)
+                    add(features, CONNECTED_ROOK, sign);
+            }
+
+            pieces = board.getPieces<QUEEN>(c);
+            while (pieces)
+            {
+                Square sq = pieces.lsb();
+                pieces.clear(sq);
+                add(features, QUEEN_TROPISM + G::DISTANCE[enemyKing][sq], sign);
+                add(features, QUEEN_TROPISM + G::DISTANCE[king][sq], sign * openingModifier);
+            }
+        }
+
+        // King shields
+        BB wShield = Eval::kingShield<WHITE>(wking),
+           bShield = Eval::kingShield<BLACK>(bking);
+        double shieldScale = std::min(Eval::KING_SAFETY_MOVES, board.getFullMoveCounter()) / (double)Eval::KING_SAFETY_MOVES * openingModifier;
+        add(features, STRONG_KING_SHIELD,
+            ((wShield & wPawns).count() - (bShield & bPawns).count()) * shieldScale);
+        add(features, WEAK_KING_SHIELD,
+            ((wShield.shift_no() & wPawns).count() - (bShield.shift_so() & bPawns).count()) * shieldScale);
+
+        // King attacks, whose danger table is fixed and only scaled
+        Eval::Attacks attacks = attackMaps(board);
+        add(features, KING_ATTACK, (board.calculateKingDanger(BLACK, attacks) - board.calculateKingDanger(WHITE, attacks))
+                                   / 100.0 * openingModifier);
+
+        extractMobility<KNIGHT>(board, features);
+        extractMobility<BISHOP>(board, features);
+        extractMobility<ROOK  >(board, features);
+        extractMobility<QUEEN >(board, features);
+
+        // Drawish endgames scale everything but the tempo bonus
+        int scale = Endgame::scale(board);
+        if (scale != Endgame::SCALE_NORMAL)
+            for (auto it = features.begin() + (long)begin; it != features.end(); ++it)
+                it->coef = it->coef * scale / Endgame::SCALE_NORMAL;
+
+        // The tempo bonus is for the side to move
+        add(features, TEMPO, board.sideToMove() == WHITE ? 1 : -1);
+
+        // Merge repeated parameters, such as the tropism of several pieces
+        auto first = features.begin() + (long)begin;
+        std::sort(first, features.end(), [](const Feature& a, const Feature& b) { return a.op < b.op; });
+        auto last = first;
+        for (auto it = first; it != features.end(); ++it)
+        {
+            if (last != first && (last - 1)->op == it->op)
+                (last - 1)->coef += it->coef;
+            else
+                *last++ = *it;
+        }
+        features.erase(std::remove_if(first, last, [](const Feature& f) { return f.coef == 0; }),
+                       features.end());
+    }
+
+    // Evaluation of a position from white's point of view, given its
+    // features and opening phase weight
+    double evaluate(const Params& params, const Feature* begin, const Feature* end, double phase)
+    {
+        double score = 0;
+        for (auto f = begin; f != end; ++f)
+        {
+            if (f->eg == NO_PARAM)
+                score += f->coef * params[f->op];
+            else
+                score += f->coef * (phase * params[f->op] + (1 - phase) * params[f->eg]);
+        }
+        return score;
+    }
+
+    /**
+     *  Loading positions
+     */
+
+    // Parse a line of `Antonius pgn` output, `<fen> c9 "<result>";`
+    static bool parseLine(std::string_view line, std::string& fen, float& result)
+    {
+        auto c9 = line.find("c9 \"");
+        if (c9 == std::string_view::npos)
+            return false;
+
+        auto value = line.substr(c9 + 4);
+        if (value.substr(0, 3) == "1-0")
+            result = 1.0f;
+        else if (value.substr(0, 3) == "0-1")
+            result = 0.0f;
+        else if (value.substr(0, 7) == "1/2-1/2")
+            result = 0.5f;
+        else
+            return false;
+
+        fen.assign(line.data(), c9);
+        return true;
+    }
+
+    // Positions with a check or a profitable capture are not labelled by
+    // their static eval, so only those whose quiescence score is their
+    // static eval are kept. Recognized endgames are not scored by the
+    // parameters at all
+    static bool isQuiet(Board& board, Search& search)
+    {
+        int known;
+        return !board.isCheck()
+            && !Endgame::probe(board, known)
+            && search.quiesce(-MATESCORE, MATESCORE) == board.eval<false>();
+    }
+
+    std::vector<Dataset> load(const std::string& filename, unsigned nThreads, Stats& stats)
+    {
+        std::vector<Dataset> shards(nThreads);
+
+        MappedFile file(filename);
+        if (!file.isOpen())
+            return shards;
+
+        // Split the file at line boundaries, one part per thread
+        std::string_view text = file.text();
+        std::vector<std::string_view> parts;
+        for (unsigned i = 0; i < nThreads; i++)
+        {
+            size_t end = i + 1 == nThreads ? text.size() : text.size() / (nThreads - i);
+            end = text.find('\n', end);
+            end = end == std::string_view::npos ? text.size() : end + 1;
+            parts.push_back(text.substr(0, end));
+            text.remove_prefix(end);
+        }
+
+        std::vector<U64> lines(nThreads, 0);
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < nThreads; i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                Board board(G::STARTFEN);
+                Search search(&board);
+                search.reset();
+                search.setOutput(nullptr);
+
+                auto& shard = shards[i];
+                std::string_view part = parts[i];
+                std::string fen;
+                float result;
+
+                while (!part.empty())
+                {
+                    size_t end = part.find('\n');
+                    std::string_view line = part.substr(0, end);
+                    part.remove_prefix(end == std::string_view::npos ? part.size() : end + 1);
+                    if (!parseLine(line, fen, result))
+                        continue;
+
+                    lines[i]++;
+                    board = Board(fen);
+                    if (!isQuiet(board, search))
+                        continue;
+
+                    extract(board, shard.features);
+                    shard.ends.push_back((U32)shard.features.size());
+                    shard.phases.push_back((float)board.calculatePhase() / TOTALPHASE);
+                    shard.results.push_back(result);
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        for (unsigned i = 0; i < nThreads; i++)
+        {
+            stats.lines += lines[i];
+            stats.positions += shards[i].size();
+        }
+
+        return shards;
+    }
+
+    /**
+     *  Optimization
+     */
+
+    // Expected score of an eval, scaled by K, as in the Texel tuning method
+    static inline double sigmoid(double K, double score)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -K * score / 400.0));
+    }
+
+    // Run a job on every shard, each in its own thread
+    template<typename F>
+    static void forEachShard(const std::vector<Dataset>& shards, F&& job)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < shards.size(); i++)
+            workers.emplace_back([&, i]() { job(i, shards[i]); });
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    double loss(const std::vector<Dataset>& shards, const Params& params, double K)
+    {
+        std::vector<double> errors(shards.size(), 0);
+        forEachShard(shards, [&](unsigned i, const Dataset& shard)
+        {
+            U32 begin = 0;
+            for (size_t n = 0; n < shard.size(); n++)
+            {
+                double score = evaluate(params, &shard.features[begin], &shard.features[0] + shard.ends[n],
+                                        shard.phases[n]);
+                double error = shard.results[n] - sigmoid(K, score);
+                errors[i] += error * error;
+                begin = shard.ends[n];
+            }
+        });
+
+        size_t n = 0;
+        double error = 0;
+        for (unsigned i = 0; i < shards.size(); i++)
+        {
+            n += shards[i].size();
+            error += errors[i];
+        }
+        return n ? error / n : 0;
+    }
+
+    // The scaling constant minimizing the loss of the current parameters,
+    // found by a golden section search
+    double fitK(const std::vector<Dataset>& shards, const Params& params)
+    {
+        const double ratio = (std::sqrt(5.0) - 1) / 2;
+        double a = 0.0, b = 4.0;
+        double c = b - ratio * (b - a),
+               d = a + ratio * (b - a);
+        double lc = loss(shards, params, c),
+               ld = loss(shards, params, d);
+
+        for (int i = 0; i < 40; i++)
+        {
+            if (lc < ld)
+            {
+                b = d; d = c; ld = lc;
+                c = b - ratio * (b - a);
+                lc = loss(shards, params, c);
+            }
+            else
+            {
+                a = c; c = d; lc = ld;
+                d = a + ratio * (b - a);
+                ld = loss(shards, params, d);
+            }
+        }
+
+        return (a + b) / 2;
+    }
+
+    // Gradient of the loss, summed over the shards in parallel
+    static void gradient(const std::vector<Dataset>& shards, const Params& params, double K, Params& grad)
+    {
+        std::vector<Params> grads(shards.size(), Params(NPARAMS, 0));
+        forEachShard(shards, [&](unsigned i, const Dataset& shard)
+        {
+            auto& g = grads[i];
+            U32 begin = 0;
+            for (size_t n = 0; n < shard.size(); n++)
+            {
+                const Feature* first = &shard.features[0] + begin;
+                const Feature* last = &shard.features[0] + shard.ends[n];
+                double phase = shard.phases[n];
+                double s = sigmoid(K, evaluate(params, first, last, phase));
+                double delta = (s - shard.results[n]) * s * (1 - s);
+
+                for (auto f = first; f != last; ++f)
+                {
+                    if (f->eg == NO_PARAM)
+                        g[f->op] += delta * f->coef;
+                    else
+                    {
+                        g[f->op] += delta * f->coef * phase;
+                        g[f->eg] += delta * f->coef * (1 - phase);
+                    }
+                }
+                begin = shard.ends[n];
+            }
+        });
+
+        // Constant factors of the derivative of the mean squared error
+        size_t n = 0;
+        for (auto& shard : shards)
+            n += shard.size();
+        double scale = n ? 2.0 * K * std::log(10.0) / 400.0 / n : 0;
+
+        std::fill(grad.begin(), grad.end(), 0);
+        for (auto& g : grads)
+            for (unsigned i = 0; i < NPARAMS; i++)
+                grad[i] += g[i] * scale;
+    }
+
+    Stats tune(const Options& options, Params& params, std::ostream& log)
+    {
+        Stats stats;
+        auto shards = load(options.input, options.threads, stats);
+        log << "positions " << stats.positions << " of " << stats.lines << std::endl;
+
+        stats.K = options.K > 0 ? options.K : fitK(shards, params);
+        stats.startLoss = stats.loss = loss(shards, params, stats.K);
+        log << "K " << stats.K << " loss " << stats.startLoss << std::endl;
+
+        // Adam, with a learning rate in centipawns
+        const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+        Params grad(NPARAMS, 0), m(NPARAMS, 0), v(NPARAMS, 0);
+
+        for (int epoch = 1; epoch <= options.epochs; epoch++)
+        {
+            gradient(shards, params, stats.K, grad);
+
+            double c1 = 1 - std::pow(beta1, epoch),
+                   c2 = 1 - std::pow(beta2, epoch);
+            for (unsigned i = 0; i < NPARAMS; i++)
+            {
+                m[i] = beta1 * m[i] + (1 - beta1) * grad[i];
+                v[i] = beta2 * v[i] + (1 - beta2) * grad[i] * grad[i];
+                params[i] -= options.rate * (m[i] / c1) / (std::sqrt(v[i] / c2) + epsilon);
+            }
+
+            if (epoch % 100 == 0 || epoch == options.epochs)
+            {
+                stats.loss = loss(shards, params, stats.K);
+                log << "epoch " << epoch << " loss " << stats.loss << std::endl;
+            }
+        }
+
+        return stats;
+    }
+
+    /**
+     *  Writing the generated header
+     */
+
+    static void writeRow(std::ostream& os, const Params& params, unsigned begin, unsigned n, int width)
+    {
+        for (unsigned i = 0; i < n; i++)
+            os << std::setw(width) << std::lround(params[begin + i]) << (i + 1 < n ? "," : "");
+    }
+
+    static void writePair(std::ostream& os, const char* name, const Params& params, unsigned param)
+    {
+        os << "    const int " << std::left << std::setw(21) << (std::string(name) + "[2]") << std::right
+           << " = {";
+        writeRow(os, params, param, 2, 5);
+        os << " };\n";
+    }
+
+    static void writeScalar(std::ostream& os, const char* name, const Params& params, unsigned param)
+    {
+        os << "    const int " << std::left << std::setw(25) << name << std::right
+           << " = " << std::lround(params[param]) << ";\n";
+    }
+
+    static void writeTable(std::ostream& os, const char* name, const Params& params, unsigned param)
+    {
+        os << "    const int " << name << "[8] = {\n        ";
+        writeRow(os, params, param, 8, 4);
+        os << "\n    };\n\n";
+    }
+
+    void write(std::ostream& os, const Params& params)
+    {
+        static const char* pieceNames[6] = { "Pawn", "Knight", "Bishop", "Rook", "Queen", "King" };
+
+        os << "#ifndef ANTONIUS_EVALPARAMS_H\n"
+           << "#define ANTONIUS_EVALPARAMS_H\n\n"
+           << "// Evaluation parameters, included by eval.cpp only\n"
+           << "// Generated by Antonius tune, see tuner.hpp\n\n"
+           << "#include \"types.hpp\"\n\n"
+           << "namespace Eval\n{\n\n";
+
+        os << "    const int MobilityScaling[2][6] = {\n";
+        for (unsigned phase = OPENING; phase <= ENDGAME; phase++)
+        {
+            os << "        {";
+            writeRow(os, params, MOBILITY + 6*phase, 6, 4);
+            os << (phase == OPENING ? " },\n" : " }\n");
+        }
+        os << "    };\n\n";
+
+        writePair(os, "PassedPawnBonus",   params, PASSED_PAWN);
+        writePair(os, "DoublePawnPenalty", params, DOUBLE_PAWN);
+        writePair(os, "TriplePawnPenalty", params, TRIPLE_PAWN);
+        writePair(os, "IsoPawnPenalty",    params, ISO_PAWN);
+        writePair(os, "OpenFileBonus",     params, OPEN_FILE);
+        writePair(os, "HalfOpenFileBonus", params, HALF_OPEN_FILE);
+        writePair(os, "BishopPairBonus",   params, BISHOP_PAIR);
+        os << "\n";
+
+        writeScalar(os, "TEMPO_BONUS",              params, TEMPO);
+        writeScalar(os, "KNIGHT_PENALTY_PER_PAWN",  params, KNIGHT_PAWN);
+        writeScalar(os, "ROOK_BONUS_PER_PAWN",      params, ROOK_PAWN);
+        writeScalar(os, "CONNECTED_ROOK_BONUS",     params, CONNECTED_ROOK);
+        writeScalar(os, "ROOK_ON_SEVENTH_BONUS",    params, ROOK_ON_SEVENTH);
+        writeScalar(os, "BACK_RANK_MINOR_PENALTY",  params, BACK_RANK_MINOR);
+        writeScalar(os, "MINOR_OUTPOST_BONUS",      params, MINOR_OUTPOST);
+        writeScalar(os, "STRONG_KING_SHIELD_BONUS", params, STRONG_KING_SHIELD);
+        writeScalar(os, "WEAK_KING_SHIELD_BONUS",   params, WEAK_KING_SHIELD);
+        writeScalar(os, "KING_ATTACK_SCALE",        params, KING_ATTACK);
+        os << "\n";
+
+        // The king's value is not tuned, as both sides always have one
+        os << "    const int PieceValues[6][2] = {\n";
+        for (unsigned piece = 0; piece < 6; piece++)
+        {
+            long value = piece < 5 ? std::lround(params[PIECE_VALUE + piece]) : (long)Eval::PieceValues[piece][WHITE];
+            os << "        { " << std::setw(6) << -value << ", " << std::setw(5) << value
+               << (piece < 5 ? " },\n" : " }\n");
+        }
+        os << "    };\n\n";
+
+        writeTable(os, "KNIGHT_TROPISM", params, KNIGHT_TROPISM);
+        writeTable(os, "BISHOP_TROPISM", params, BISHOP_TROPISM);
+        writeTable(os, "ROOK_TROPISM",   params, ROOK_TROPISM);
+        writeTable(os, "QUEEN_TROPISM",  params, QUEEN_TROPISM);
+
+        os << "    const int PieceSqValues[6][2][64] =\n    {\n";
+        for (unsigned piece = 0; piece < 6; piece++)
+        {
+            os << "        { // " << pieceNames[piece] << " piece square values\n";
+            for (unsigned phase = OPENING; phase <= ENDGAME; phase++)
+            {
+                os << "            {\n";
+                for (unsigned rank = 0; rank < 8; rank++)
+                {
+                    os << "               ";
+                    writeRow(os, params, PIECE_SQUARE + 128*piece + 64*phase + 8*rank, 8, 5);
+                    os << (rank < 7 ? ",\n" : "\n");
+                }
+                os << (phase == OPENING ? "            }, // Opening\n\n" : "            }  // End game\n");
+            }
+            os << (piece < 5 ? "        },\n\n" : "        }\n");
+        }
+        os << "    };\n\n}\n\n#endif\n";
+    }
+
+    Options parseArgs(const VecStr& args)
+    {
+        Options options;
+
+        for (unsigned i = 0; i + 1 < args.size(); i++)
+        {
+            auto& flag = args.at(i);
+            auto& value = args.at(i+1);
+
+            if (flag == "--input")
+                options.input = value;
+            else if (flag == "--output")
+                options.output = value;
+            else if (flag == "--threads")
+                options.threads = std::max(1u, (unsigned)std::stoi(value));
+            else if (flag == "--epochs")
+                options.epochs = std::stoi(value);
+            else if (flag == "--rate")
+                options.rate = std::stod(value);
+            else if (flag == "--k")
+                options.K = std::stod(value);
+            else
+                continue;
+
+            i++;
+        }
+
+        return options;
+    }
+
+    int main(const VecStr& args)
+    {
+        Options options = parseArgs(args);
+        if (options.input.empty())
+        {
+            std::cerr << "Usage: Antonius tune --input <epd> [--output <hpp>] [--threads N]"
+                      << " [--epochs N] [--rate R] [--k K]" << std::endl;
+            return 1;
+        }
+        if (!std::ifstream(options.input))
+        {
+            std::cerr << "Cannot open " << options.input << std::endl;
+            return 1;
+        }
+
+        Params params = defaults();
+        tune(options, params, std::cerr);
+
+        std::ofstream ofs(options.output);
+        write(ofs, params);
+        std::cerr << "wrote " << options.output << std::endl;
+
+        return 0;
+    }
+
+}
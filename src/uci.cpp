@@ -1,8 +1,11 @@
 #include "uci.hpp"
-#include <sstream>
 #include "tt.hpp"
 #include "movegen.hpp"
 #include "move.hpp"
+#include "epd.hpp"
+#include "notation.hpp"
+#include "tablebase.hpp"
+#include <thread>
 
 namespace UCI {
 
@@ -10,9 +13,13 @@ namespace UCI {
 		: board(G::STARTFEN)
 		, search(&board)
 		, _debug(false)
+        , ownBook(false)
+        , bookFile("book.bin")
         , istream(is)
         , ostream(os)
-	{ }
+	{
+        search.setOutput(&ostream);
+    }
 
     void Controller::loop()
     {
@@ -45,10 +52,10 @@ namespace UCI {
             ostream << "readyok" << std::endl;
 
         else if (cmd == "setoption")
-            ostream << "TODO: implement uci options" << std::endl;
+            setoption(tokens);
 
         else if (cmd == "ucinewgame")
-            ostream << "TODO: clear transposition table" << std::endl;
+            TT::table.clear();
 
         else if (cmd == "position")
             position(tokens);
@@ -59,6 +66,9 @@ namespace UCI {
         else if (cmd == "move")
             move(tokens);
 
+        else if (cmd == "epd")
+            epd(tokens);
+
         else if (cmd == "moves")
             moves();
 
@@ -86,15 +96,94 @@ namespace UCI {
         // Identify the engine
         ostream << "id name Antonius 0.1.0" << std::endl;
         ostream << "id author Eric VanderHelm" << std::endl;
+
+        // List the supported options and their defaults
+        SearchOptions defaults;
+        ostream << "option name RazorMargin type spin default "
+                << defaults.razorMargin << " min 0 max " << SearchOptions::MAX_MARGIN << std::endl;
+        ostream << "option name FutilityMargin type spin default "
+                << defaults.futilityMargin << " min 0 max " << SearchOptions::MAX_MARGIN << std::endl;
+        ostream << "option name ReverseFutilityMargin type spin default "
+                << defaults.reverseFutilityMargin << " min 0 max " << SearchOptions::MAX_MARGIN << std::endl;
+        ostream << "option name LazyEvalMargin type spin default "
+                << defaults.lazyEvalMargin << " min 0 max " << SearchOptions::MAX_LAZY_MARGIN << std::endl;
+        ostream << "option name LazyMobilityMargin type spin default "
+                << defaults.lazyMobilityMargin << " min 0 max " << SearchOptions::MAX_LAZY_MARGIN << std::endl;
+        ostream << "option name MultiPV type spin default "
+                << defaults.multiPV << " min 1 max " << SearchOptions::MAX_MULTIPV << std::endl;
+        ostream << "option name OwnBook type check default false" << std::endl;
+        ostream << "option name BookFile type string default book.bin" << std::endl;
+        ostream << "option name TablebasePath type string default <empty>" << std::endl;
+
         ostream << "uciok" << std::endl;
     }
 
+    void Controller::setoption(VecStr& tokens)
+    {
+        // Parse "name <id> [value <x>]", where the id may contain spaces
+        std::string name = "",
+                    value = "";
+        std::string* field = nullptr;
+
+        for (auto& token : tokens)
+        {
+            if (token == "name")
+                field = &name;
+            else if (token == "value")
+                field = &value;
+            else if (field)
+                *field += (field->empty() ? "" : " ") + token;
+        }
+
+        if (name == "OwnBook" || name == "BookFile")
+        {
+            if (name == "OwnBook")
+                ownBook = value == "true";
+            else
+                bookFile = value;
+
+            // Map the book as soon as it is enabled
+            book.close();
+            if (ownBook && !book.open(bookFile))
+                ostream << "info string cannot open book " << bookFile << std::endl;
+        }
+
+        else if (name == "TablebasePath")
+        {
+            int n = value == "<empty>" ? 0 : Tablebase::load(value);
+            if (!n)
+                Tablebase::clear();
+            ostream << "info string " << n << " tablebases found" << std::endl;
+        }
+
+        else
+        {
+            // Spin options take a whole number, clamped to their range
+            int n = 0;
+            size_t end = 0;
+            try
+            {
+                n = std::stoi(value, &end);
+            }
+            catch (const std::logic_error&)
+            {
+                end = 0;
+            }
+
+            if (end == 0 || end != value.size())
+                ostream << "info string invalid value " << value << " for option " << name << std::endl;
+            else if (!search.options.set(name, n))
+                ostream << "info string unknown option " << name << std::endl;
+        }
+    }
+
     void Controller::setdebug(VecStr& tokens)
     {
         if (tokens.at(0) == "on")
             _debug = true;
         else if (tokens.at(0) == "off")
             _debug = false;
+        search.setDebug(_debug);
     }
 
     void Controller::position(VecStr& tokens)
@@ -105,7 +194,9 @@ namespace UCI {
         if (pos == "startpos")
         {
             board = Board(G::STARTFEN);
-            search = Search(&board);
+            search = Search(&board, search.options);
+            search.setOutput(&ostream);
+            search.setDebug(_debug);
 
             if (_debug)
                 ostream << board;
@@ -123,7 +214,9 @@ namespace UCI {
             }
 
             board = Board(fen);
-            search = Search(&board);
+            search = Search(&board, search.options);
+            search.setOutput(&ostream);
+            search.setDebug(_debug);
 
             if (_debug)
                 ostream << board;
@@ -136,20 +229,77 @@ namespace UCI {
 
     void Controller::go(VecStr& tokens)
     {
-        std::string mode = tokens.at(0);
-        tokens.erase(tokens.begin());
-        
-        if (mode == "perft")
+        SearchLimits limits;
+        int time[NCOLORS] = {},
+            inc[NCOLORS] = {},
+            movesToGo = 0;
+
+        for (unsigned i = 0; i < tokens.size(); i++)
         {
-            auto depth = std::stoi(tokens.at(0));
-            search.perft<true>(depth);
+            auto& mode = tokens.at(i);
+
+            // Flags without a value
+            if (mode == "infinite" || mode == "ponder")
+                continue;
+            if (i + 1 >= tokens.size())
+                break;
+            auto& value = tokens.at(++i);
+
+            if (mode == "perft")
+            {
+                search.perft<true>(std::stoi(value));
+                return;
+            }
+
+            else if (mode == "depth")
+                limits.depth = std::stoi(value);
+
+            else if (mode == "nodes")
+                limits.nodes = std::stoull(value);
+
+            else if (mode == "mate")
+                limits.mate = std::stoi(value);
+
+            else if (mode == "movetime")
+                limits.movetime = std::stoi(value);
+
+            else if (mode == "wtime" || mode == "btime")
+                time[mode == "wtime" ? WHITE : BLACK] = std::stoi(value);
+
+            else if (mode == "winc" || mode == "binc")
+                inc[mode == "winc" ? WHITE : BLACK] = std::stoi(value);
+
+            else if (mode == "movestogo")
+                movesToGo = std::stoi(value);
         }
 
-        else if (mode == "depth")
+        // On a clock, spend a share of the remaining time and most of the
+        // increment, keeping a margin for the overhead
+        Color us = board.sideToMove();
+        if (!limits.movetime && time[us] > 0)
         {
-            auto depth = std::stoi(tokens.at(0));
-            search.think(depth);
+            int budget = time[us] / (movesToGo > 0 ? movesToGo : MOVES_TO_GO) + 3 * inc[us] / 4;
+            limits.movetime = std::max(1, std::min(budget, time[us] - MOVE_OVERHEAD));
         }
+
+        // The search cannot be stopped while it runs, so an infinite or
+        // unlimited search is given a fixed time instead
+        if (!limits.depth && !limits.nodes && !limits.mate && !limits.movetime)
+            limits.movetime = DEFAULT_MOVETIME;
+
+        // Play a book move without searching, if there is one
+        if (ownBook && book.isOpen())
+        {
+            Move move = book.pick(board);
+            if (!move.isNullMove())
+            {
+                ostream << "info string book move" << std::endl;
+                ostream << "bestmove " << move << std::endl;
+                return;
+            }
+        }
+
+        search.think(limits);
     }
 
     void Controller::move(VecStr& tokens)
@@ -163,23 +313,67 @@ namespace UCI {
         }
         else
         {
-            auto gen = MoveGen::Generator(&board);
-            gen.run();
+            // Accept both UCI and SAN moves
+            Move move = Notation::fromUCI(board, tokens.at(0));
+            if (move.isNullMove())
+                move = Notation::fromSAN(board, tokens.at(0));
 
-            for ( auto& move : gen.moves )
+            if (move.isNullMove())
             {
-                std::ostringstream oss;
-                oss << move;
+                ostream << "info string illegal move " << tokens.at(0) << std::endl;
+                return;
+            }
 
-                if (oss.str() == tokens.at(0))
-                {
-                    board.make(move);
+            board.make(move);
 
-                    if (_debug)
-                        ostream << board;
-                }
-            }
+            if (_debug)
+                ostream << board;
+        }
+    }
+
+    void Controller::epd(VecStr& tokens)
+    {
+        if (tokens.empty())
+            return;
+
+        // Parse "epd <file> [movetime <x>] [nodes <x>] [depth <x>] [threads <x>] [hash <x>]"
+        SearchLimits limits;
+        unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+        size_t hashBytes = 16 << 20;
+
+        for (unsigned i = 1; i + 1 < tokens.size(); i += 2)
+        {
+            auto& mode = tokens.at(i);
+            auto& value = tokens.at(i+1);
+
+            if (mode == "movetime")
+                limits.movetime = std::stoi(value);
+
+            else if (mode == "nodes")
+                limits.nodes = std::stoull(value);
+
+            else if (mode == "depth")
+                limits.depth = std::stoi(value);
+
+            else if (mode == "threads")
+                nThreads = (unsigned)std::stoi(value);
+
+            else if (mode == "hash")
+                hashBytes = (size_t)std::stoull(value) << 20;
+        }
+
+        // Default to a second per position
+        if (!limits.movetime && !limits.nodes && !limits.depth)
+            limits.movetime = 1000;
+
+        auto positions = EPD::load(tokens.at(0));
+        if (positions.empty())
+        {
+            ostream << "info string no positions in " << tokens.at(0) << std::endl;
+            return;
         }
+
+        EPD::run(positions, limits, search.options, nThreads, hashBytes, ostream);
     }
 
     void Controller::moves()
@@ -8,6 +8,7 @@ namespace Zobrist
     U64 stm;
     U64 ep[8];
     U64 castle[NCOLORS][2];
+    U64 material[NCOLORS][NPIECETYPES][MAX_PIECES];
 
     void init()
     {
@@ -28,6 +29,11 @@ namespace Zobrist
             castle[i][0] = r();
             castle[i][1] = r();
         }
+
+        for (int i = 0; i < NCOLORS; i++)
+            for (int j = 0; j < NPIECETYPES; j++)
+                for (int k = 0; k < MAX_PIECES; k++)
+                    material[i][j][k] = r();
     }
 
 }
\ No newline at end of file
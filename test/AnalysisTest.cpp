@@ -0,0 +1,64 @@
+#include "catch.hpp"
+#include <sstream>
+#include "globals.hpp"
+#include "analysis.hpp"
+
+TEST_CASE( "Batch analysis tests", "[analysis]" )
+{
+    G::init();
+
+    SECTION("Parse arguments")
+    {
+        auto options = Analysis::parseArgs({ "analyse", "--input", "positions.epd",
+                                             "--threads", "32", "--depth", "12", "--hash", "256" });
+
+        REQUIRE(options.input == "positions.epd");
+        REQUIRE(options.output == "-");
+        REQUIRE(options.threads == 32);
+        REQUIRE(options.limits.depth == 12);
+        REQUIRE(options.hashBytes == 256u << 20);
+
+        REQUIRE(Analysis::parseArgs({ "analyse" }).limits.depth == 10);
+        REQUIRE(Analysis::parseArgs({ "analyse", "--hash", "8192" }).hashBytes == size_t(8192) << 20);
+    }
+
+    SECTION("Analyse positions")
+    {
+        std::istringstream iss(
+            "7R/8/8/8/8/1K6/8/1k6 w - - 0 1\n"
+            "\n"
+            "5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - - id \"mate2\";\n"
+            "R1R5/7R/1k6/7R/8/8/8/1K6 b - -\n");
+        std::ostringstream oss;
+
+        auto options = Analysis::parseArgs({ "analyse", "--threads", "2", "--depth", "4", "--hash", "1" });
+        auto stats = Analysis::run(options, iss, oss);
+
+        REQUIRE(stats.positions == 3);
+        REQUIRE(stats.nodes > 0);
+
+        auto lines = G::split(oss.str(), '\n');
+        std::sort(lines.begin(), lines.end());
+        REQUIRE(lines.size() == 3);
+        REQUIRE(lines.at(0).find("{\"index\":0,\"fen\":\"7R/8/8/8/8/1K6/8/1k6 w - -\",\"bestmove\":\"h8h1\",\"score\":{\"mate\":1}") == 0);
+        REQUIRE(lines.at(1).find("{\"index\":2,\"id\":\"mate2\"") == 0);
+        REQUIRE(lines.at(1).find("\"bestmove\":\"c6g2\",\"score\":{\"mate\":2}") != std::string::npos);
+        REQUIRE(lines.at(2).find("\"bestmove\":null,\"score\":{\"cp\":0},\"depth\":") != std::string::npos);
+    }
+
+    SECTION("Positions are searched from an empty table")
+    {
+        std::istringstream iss(
+            "5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - -\n"
+            "5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - -\n");
+        std::ostringstream oss;
+
+        auto options = Analysis::parseArgs({ "analyse", "--depth", "4", "--hash", "1" });
+        Analysis::run(options, iss, oss);
+
+        // The second search is not helped by the first
+        auto lines = G::split(oss.str(), '\n');
+        REQUIRE(lines.size() == 2);
+        REQUIRE(lines.at(0).substr(lines.at(0).find("\"fen\"")) == lines.at(1).substr(lines.at(1).find("\"fen\"")));
+    }
+}
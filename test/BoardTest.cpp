@@ -44,4 +44,49 @@ TEST_CASE( "Board tests", "[board]" )
         REQUIRE(board.count<KING  >() == 2);
     }
 
+    SECTION("Attack maps")
+    {
+        auto board = Board(G::KIWIPETE);
+        BB occ = board.occupancy(),
+           targets = ~board.getPieces<ALL>(WHITE);
+        Eval::Attacks attacks;
+        for (Square sq : { E5, C3 })
+            attacks.add(WHITE, KNIGHT, MoveGen::movesByPiece<KNIGHT>(sq, occ), targets);
+        for (Square sq : { D2, E2 })
+            attacks.add(WHITE, BISHOP, MoveGen::movesByPiece<BISHOP>(sq, occ), targets);
+
+        REQUIRE(attacks.moves[WHITE][KNIGHT] == MoveGen::mobility<KNIGHT>(board.getPieces<KNIGHT>(WHITE), targets, occ));
+        REQUIRE(attacks.moves[WHITE][BISHOP] == MoveGen::mobility<BISHOP>(board.getPieces<BISHOP>(WHITE), targets, occ));
+        REQUIRE(attacks.moves[BLACK][KNIGHT] == 0);
+
+        // The e5 knight and the e2 bishop both attack d3, only the d2 bishop f4
+        REQUIRE(attacks.all[WHITE].isSet(F4));
+        REQUIRE(!attacks.twice[WHITE].isSet(F4));
+        REQUIRE(attacks.twice[WHITE].isSet(D3));
+        REQUIRE(attacks.byType[WHITE][KNIGHT].isSet(D3));
+    }
+
+    SECTION("King danger")
+    {
+        auto board = Board("r1bq1rk1/pp2nppp/2n1p3/3pP3/1b1P3Q/2NB1N2/PP3PPP/R1B1K2R w KQ - 0 9");
+        BB occ = board.occupancy();
+        Eval::Attacks attacks;
+        attacks.kingZone[WHITE] = BB(G::KING_ATTACKS[E1]) | E1;
+        attacks.kingZone[BLACK] = BB(G::KING_ATTACKS[G8]) | G8;
+        attacks.add(BLACK, KING, BB(G::KING_ATTACKS[G8]));
+
+        // A lone attacker is no danger
+        attacks.add(WHITE, QUEEN, MoveGen::movesByPiece<QUEEN>(H4, occ));
+        REQUIRE(attacks.kingAttackers[WHITE] == 1);
+        REQUIRE(board.calculateKingDanger(BLACK, attacks) == 0);
+
+        // The queen and bishop both hit h7, which the king covers, so
+        // neither has a safe check
+        attacks.add(WHITE, BISHOP, MoveGen::movesByPiece<BISHOP>(D3, occ));
+        REQUIRE(attacks.kingAttackers[WHITE] == 2);
+        REQUIRE(attacks.kingAttackUnits[WHITE] == Eval::KingAttackWeight[QUEEN] + Eval::KingAttackWeight[BISHOP]);
+        REQUIRE(board.calculateKingDanger(BLACK, attacks) == Eval::KingDanger[attacks.kingAttackUnits[WHITE]]);
+        REQUIRE(board.calculateKingDanger(WHITE, attacks) == 0);
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include "globals.hpp"
+#include "board.hpp"
+#include "polyglot.hpp"
+#include "bookbuilder.hpp"
+
+static const std::string games =
+    "[Event \"1\"]\n[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 Nc6 1-0\n\n"
+    "[Event \"2\"]\n[Result \"1/2-1/2\"]\n\n1. e4 c5 2. Nf3 1/2-1/2\n\n"
+    "[Event \"3\"]\n[Result \"0-1\"]\n\n1. d4 d5 0-1\n\n"
+    "[Event \"4\"]\n[Result \"*\"]\n\n1. c4 *\n\n";
+
+TEST_CASE( "Book builder tests", "[bookbuilder]" )
+{
+    G::init();
+
+    std::string pgnFile = "bookbuildertest.pgn",
+                bookFile = "bookbuildertest.bin";
+    {
+        std::ofstream ofs(pgnFile);
+        for (int i = 0; i < 20; i++)
+            ofs << games;
+    }
+
+    auto options = BookBuilder::parseArgs({ "book", "build", "--input", pgnFile, "--output", bookFile,
+                                            "--threads", "2", "--max-ply", "3", "--max-open-runs", "3" });
+    REQUIRE(options.threads == 2);
+    REQUIRE(options.maxPly == 3);
+    REQUIRE(options.maxOpenRuns == 3);
+    REQUIRE(BookBuilder::parseArgs({ "book", "build" }).maxOpenRuns == 64);
+
+    // A tiny memory budget forces many runs, merged three at a time
+    options.memory = 10 * sizeof(BookBuilder::Record);
+    auto stats = BookBuilder::build(options);
+
+    REQUIRE(stats.games == 60);
+    REQUIRE(stats.positions == 20 * (3 + 3 + 2));
+    REQUIRE(stats.runs > 9);
+    REQUIRE(stats.passes > 2);
+
+    Polyglot::Book book;
+    REQUIRE(book.open(bookFile));
+    REQUIRE(book.size() == stats.entries);
+
+    // 1. e4 scored a win and a draw each time, 1. d4 only lost
+    Board board(G::STARTFEN);
+    auto entries = book.probe(board.calculatePolyglotKey());
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].move == Polyglot::encodeMove(Move(E2, E4)));
+    REQUIRE(entries[0].weight == 20 * 3);
+
+    // After 1. e4, only 1... c5 drew, and games end at the third ply
+    board.make(Move(E2, E4));
+    entries = book.probe(board.calculatePolyglotKey());
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].move == Polyglot::encodeMove(Move(C7, C5)));
+    REQUIRE(entries[0].weight == 20);
+
+    board.make(Move(C7, C5));
+    entries = book.probe(board.calculatePolyglotKey());
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].weight == 20);
+
+    board.unmake();
+    board.make(Move(E7, E5));
+    entries = book.probe(board.calculatePolyglotKey());
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].weight == 40);
+    REQUIRE(book.pick(board) == Move(G1, F3));
+
+    // The file holds the standard keys, big-endian, in key order
+    {
+        std::ifstream ifs(bookFile, std::ios::binary);
+        std::vector<U64> keys;
+        unsigned char bytes[16];
+        while (ifs.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+        {
+            U64 key = 0;
+            for (int i = 0; i < 8; i++)
+                key = key << 8 | bytes[i];
+            keys.push_back(key);
+        }
+
+        REQUIRE(keys.size() == stats.entries);
+        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+        REQUIRE(std::count(keys.begin(), keys.end(), 0x463b96181691fc9c) == 1);
+        REQUIRE(std::count(keys.begin(), keys.end(), 0x823c9b50fd114196) == 1);
+    }
+
+    // Runs are removed once merged, including those of earlier passes
+    for (U64 i = 0; i < 2 * stats.runs; i++)
+        REQUIRE_FALSE(std::ifstream(bookFile + ".run" + std::to_string(i)));
+
+    book.close();
+    std::remove(pgnFile.c_str());
+    std::remove(bookFile.c_str());
+}
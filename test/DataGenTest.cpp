@@ -0,0 +1,90 @@
+#include "catch.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "globals.hpp"
+#include "board.hpp"
+#include "datagen.hpp"
+
+static std::vector<DataGen::Record> readRecords(const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    std::vector<DataGen::Record> records;
+    DataGen::Record record;
+    while (ifs.read(reinterpret_cast<char*>(&record), sizeof(record)))
+        records.push_back(record);
+    return records;
+}
+
+TEST_CASE( "Training data tests", "[datagen]" )
+{
+    G::init();
+
+    SECTION("Positions are packed and unpacked")
+    {
+        std::vector<std::pair<std::string, int>> positions = {
+            { G::STARTFEN, 0 },
+            { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b Kq - 3 12", 23 },
+            { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 4 },
+            { "8/8/4k3/8/8/4K3/8/8 w - - 40 61", 120 }
+        };
+
+        for (auto& position : positions)
+        {
+            Board board(position.first);
+            auto record = DataGen::pack(board, -35, 1, position.second);
+            REQUIRE(record.score == -35);
+            REQUIRE(record.result == 1);
+            REQUIRE(record.ply == position.second);
+            REQUIRE(Board(DataGen::unpack(record)).toFEN() == board.toFEN());
+        }
+    }
+
+    SECTION("Self-play positions are written as fixed size records")
+    {
+        std::string dataFile = "datagentest.bin",
+                    shuffledFile = "datagentest.shuffled.bin";
+
+        auto options = DataGen::parseArgs({ "datagen", "--output", dataFile, "--threads", "2",
+                                            "--positions", "200", "--nodes", "500", "--seed", "7" });
+        REQUIRE(options.threads == 2);
+        REQUIRE(options.limits.nodes == 500);
+        REQUIRE(DataGen::parseArgs({ "datagen", "--hash", "8192" }).hashBytes == size_t(8192) << 20);
+
+        auto stats = DataGen::generate(options);
+        REQUIRE(stats.positions == 200);
+        REQUIRE(stats.games > 0);
+
+        auto records = readRecords(dataFile);
+        REQUIRE(records.size() == 200);
+        for (auto& record : records)
+        {
+            Board board(DataGen::unpack(record));
+            REQUIRE(!board.isCheck());
+            REQUIRE(std::abs(record.score) < options.maxScore);
+            REQUIRE(std::abs(record.result) <= 1);
+            REQUIRE(record.ply >= options.randomPlies);
+        }
+
+        // Shuffling keeps the same records
+        options.input = dataFile;
+        options.output = shuffledFile;
+        REQUIRE(DataGen::shuffle(options) == 200);
+
+        auto shuffled = readRecords(shuffledFile);
+        REQUIRE(shuffled.size() == records.size());
+        auto less = [](const DataGen::Record& a, const DataGen::Record& b)
+        {
+            return std::memcmp(&a, &b, sizeof(DataGen::Record)) < 0;
+        };
+        std::sort(records.begin(), records.end(), less);
+        std::sort(shuffled.begin(), shuffled.end(), less);
+        REQUIRE(std::equal(records.begin(), records.end(), shuffled.begin(),
+                           [](const DataGen::Record& a, const DataGen::Record& b)
+                           { return std::memcmp(&a, &b, sizeof(DataGen::Record)) == 0; }));
+
+        std::remove(dataFile.c_str());
+        std::remove(shuffledFile.c_str());
+    }
+}
@@ -0,0 +1,121 @@
+#include "catch.hpp"
+#include "globals.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "eval.hpp"
+#include "endgame.hpp"
+#include "material.hpp"
+
+TEST_CASE( "Endgame tests", "[endgame]" )
+{
+    G::init();
+
+    SECTION("KPK bitbase")
+    {
+        // The king in front of its pawn on the sixth rank wins
+        REQUIRE(Endgame::probeKPK(WHITE, E6, E5, E8, WHITE));
+        REQUIRE(Endgame::probeKPK(WHITE, E6, E5, E8, BLACK));
+
+        // Behind it, with the move, only stalemate is left
+        REQUIRE(!Endgame::probeKPK(WHITE, E5, E6, E8, WHITE));
+
+        // The rook pawn draws against a king in the corner
+        REQUIRE(!Endgame::probeKPK(WHITE, A1, A2, A8, WHITE));
+
+        // The pawn outruns a king outside its square
+        REQUIRE(Endgame::probeKPK(WHITE, A1, A2, H2, WHITE));
+        REQUIRE(Endgame::probeKPK(WHITE, H1, H2, A2, WHITE));
+
+        // Results are the same with the colors reversed
+        for (Square wk : { A1, C3, E6, H8 })
+            for (Square pawn : { B2, D4, E5, G7 })
+                for (Square bk : { A8, D8, F6, H1 })
+                    for (Color stm : { WHITE, BLACK })
+                        REQUIRE(Endgame::probeKPK(WHITE, wk, pawn, bk, stm)
+                             == Endgame::probeKPK(BLACK, Square(wk ^ 56), Square(pawn ^ 56), Square(bk ^ 56), ~stm));
+    }
+
+    SECTION("Material keys")
+    {
+        REQUIRE(Board("8/8/8/4k3/8/8/8/KBN5 w - -").getMaterialKey() == Material::key("KBNK"));
+        REQUIRE(Board("8/8/8/4k3/8/8/8/KBN5 w - -").getMaterialKey() != Material::key("KBNK", BLACK));
+        REQUIRE(Board("8/8/8/4k3/8/8/8/KNB5 w - -").getMaterialKey() == Material::key("KNBK"));
+        REQUIRE(Board("kr6/8/8/8/8/8/8/7K w - -").getMaterialKey() == Material::key("KRK", BLACK));
+        REQUIRE(Board(G::STARTFEN).getMaterialKey() == Material::key("KQRRBBNNPPPPPPPPKQRRBBNNPPPPPPPP"));
+    }
+
+    SECTION("Material table")
+    {
+        auto& start = Material::probe(Board(G::STARTFEN));
+        REQUIRE(start.phase == TOTALPHASE);
+        REQUIRE(start.imbalance == 0);
+        REQUIRE(!start.evaluator);
+        REQUIRE(!start.scaler);
+
+        // The bishop pair, and knights losing value as pawns come off
+        Board board("4k3/8/8/8/8/8/8/2BBK3 w - -");
+        int phase = 2 * BISHOPSCORE;
+        REQUIRE(Material::probe(board).phase == phase);
+        REQUIRE(Material::probe(board).imbalance == Approx((phase * Eval::BishopPairBonus[OPENING]
+            + (TOTALPHASE - phase) * Eval::BishopPairBonus[ENDGAME]) / (double)TOTALPHASE));
+        board = Board("4k3/pppppppp/8/8/8/8/8/1N2K3 w - -");
+        REQUIRE(Material::probe(board).imbalance == 8 * Eval::KNIGHT_PENALTY_PER_PAWN);
+
+        // Entries of the same material are shared
+        auto& krk = Material::probe(Board("8/8/8/4k3/8/8/8/K6R w - -"));
+        REQUIRE(&krk == &Material::probe(Board("8/8/8/8/2k5/8/1K6/7R b - -")));
+        REQUIRE(krk.evaluator);
+        REQUIRE(krk.strong == WHITE);
+        REQUIRE(Material::probe(Board("8/8/8/4k3/8/8/8/K6r w - -")).strong == BLACK);
+    }
+
+    SECTION("Recognized endgames")
+    {
+        int score;
+        REQUIRE(!Endgame::probe(Board(G::STARTFEN), score));
+        REQUIRE(!Endgame::probe(Board("8/8/8/4k3/8/8/3P4/K6n w - -"), score));
+
+        // Insufficient material
+        for (auto fen : { "8/8/8/4k3/8/8/8/K7 w - -", "8/8/8/4k3/8/8/8/K6n w - -",
+                          "8/8/8/4k3/8/8/8/KB6 b - -", "8/8/8/4k3/8/8/8/KNN5 w - -" })
+        {
+            REQUIRE(Endgame::isKnownDraw(Board(fen)));
+            REQUIRE(Board(fen).eval<false>() == DRAWSCORE);
+        }
+
+        // Won endgames, from both sides
+        auto board = Board("8/8/8/4k3/8/8/8/K6R w - -");
+        REQUIRE(board.eval<false>() > Endgame::KNOWN_WIN);
+        board = Board("8/8/8/4k3/8/8/8/K6R b - -");
+        REQUIRE(board.eval<false>() < -Endgame::KNOWN_WIN);
+        board = Board("8/8/8/4K3/8/8/8/k6q b - -");
+        REQUIRE(board.eval<false>() > Endgame::KNOWN_WIN);
+
+        // The weak king is driven to the edge, and to the bishop's corner
+        REQUIRE(Board("8/8/8/8/3k4/8/8/K6R w - -").eval<false>()
+              < Board("8/8/8/8/k7/8/8/K6R w - -").eval<false>());
+        REQUIRE(Board("8/8/8/8/8/3K4/8/k1BN4 w - -").eval<false>()
+              > Board("8/8/8/8/8/3K4/8/2BN3k w - -").eval<false>());
+    }
+
+    SECTION("Opposite bishops are scaled towards a draw")
+    {
+        REQUIRE(Endgame::scale(Board("8/4kp2/2b5/8/8/2B5/4KPP1/8 w - -")) == Endgame::SCALE_OPPOSITE_BISHOPS);
+        REQUIRE(Endgame::scale(Board("8/4kp2/3b4/8/8/2B5/4KPP1/8 w - -")) == Endgame::SCALE_NORMAL);
+        REQUIRE(Endgame::scale(Board(G::STARTFEN)) == Endgame::SCALE_NORMAL);
+    }
+
+    SECTION("Drawn endgames are not searched")
+    {
+        SearchLimits limits;
+        limits.depth = 10;
+
+        TT::table.clear();
+        auto board = Board("8/8/8/4k3/8/8/8/K6n w - -");
+        Search search(&board);
+        search.setOutput(nullptr);
+        search.think(limits);
+        REQUIRE(search.bestScore == DRAWSCORE);
+        REQUIRE(search.getNodes() < 100);
+    }
+}
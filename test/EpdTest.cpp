@@ -0,0 +1,76 @@
+#include "catch.hpp"
+#include <sstream>
+#include "globals.hpp"
+#include "board.hpp"
+#include "notation.hpp"
+#include "epd.hpp"
+
+TEST_CASE( "EPD tests", "[epd]" )
+{
+    G::init();
+
+    SECTION("SAN moves")
+    {
+        Board board("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq -");
+
+        REQUIRE(Notation::toSAN(board, Move(F3, F7)) == "Qxf7#");
+        REQUIRE(Notation::fromSAN(board, "Qxf7#") == Move(F3, F7));
+        REQUIRE(Notation::fromSAN(board, "Qxf7") == Move(F3, F7));
+        REQUIRE(Notation::fromSAN(board, "Ne2") == Move(G1, E2));
+        REQUIRE(Notation::fromSAN(board, "Nh6") == Move());
+    }
+
+    SECTION("Parse records")
+    {
+        auto pos = EPD::parse("r1b2rk1/1p1nbppp/pq1p4/3B4/P2NP3/2N1p3/1PP3PP/R2Q1R1K w - - "
+                              "bm Rxf7; id \"arasan20.2\"; c0 \"Van der Wiel-Ribli, IBM Amsterdam 1980\";");
+
+        REQUIRE(pos.fen == "r1b2rk1/1p1nbppp/pq1p4/3B4/P2NP3/2N1p3/1PP3PP/R2Q1R1K w - - ");
+        REQUIRE(pos.id == "arasan20.2");
+        REQUIRE(pos.bestMoves == VecStr({ "Rxf7" }));
+        REQUIRE(pos.avoidMoves.empty());
+
+        pos = EPD::parse("R1R5/7R/1k6/7R/8/P1P5/PKP5/1RP5 w - - am Rb8 Rcb8; bm Ka1; id \"stalemate\";");
+        REQUIRE(pos.bestMoves == VecStr({ "Ka1" }));
+        REQUIRE(pos.avoidMoves == VecStr({ "Rb8", "Rcb8" }));
+    }
+
+    SECTION("Run a suite")
+    {
+        std::vector<EPD::Position> positions = {
+            EPD::parse("7R/8/8/8/8/1K6/8/1k6 w - - bm Rh1#; id \"mate1\";"),
+            EPD::parse("5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - - bm Qxg2+; id \"mate2\";"),
+            EPD::parse("k7/8/4r3/8/8/3Q4/4p3/K7 w - - am e1=Q; id \"nosuchmove\";"),
+        };
+
+        SearchLimits limits;
+        limits.nodes = 20000;
+        std::ostringstream oss;
+        auto results = EPD::run(positions, limits, SearchOptions(), 2, 1 << 20, oss);
+
+        REQUIRE(results.size() == 3);
+        REQUIRE(results[0].solved);
+        REQUIRE(results[0].move == "Rh1#");
+        REQUIRE(results[1].solved);
+        REQUIRE(results[1].id == "mate2");
+        REQUIRE(results[2].solved);
+        REQUIRE(oss.str().find("info string epd solved 3/3") != std::string::npos);
+    }
+
+    SECTION("Time to solution counts from the start of the search")
+    {
+        // Making luft against the back rank mate, which a depth 1 search misses
+        auto position = EPD::parse("6k1/pp3ppp/8/8/8/8/1Q3PPP/3R2K1 b - - bm f6 f5 g6 g5 h6 h5; id \"luft\";");
+        SearchLimits limits;
+        limits.depth = 1;
+        std::ostringstream oss;
+        auto shallow = EPD::run({ position }, limits, SearchOptions(), 1, 1 << 20, oss);
+        REQUIRE(!shallow[0].solved);
+
+        limits.depth = 6;
+        auto results = EPD::run({ position }, limits, SearchOptions(), 1, 1 << 20, oss);
+        REQUIRE(results[0].solved);
+        REQUIRE(results[0].solutionNodes > shallow[0].nodes);
+        REQUIRE(results[0].solutionNodes <= results[0].nodes);
+    }
+}
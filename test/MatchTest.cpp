@@ -0,0 +1,117 @@
+#include "catch.hpp"
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include "globals.hpp"
+#include "match.hpp"
+#include "board.hpp"
+#include "tablebase.hpp"
+
+TEST_CASE( "Self-play match tests", "[match]" )
+{
+    G::init();
+
+    SECTION("SPRT")
+    {
+        Match::SPRT sprt = { 0, 5, 0.05, 0.05 };
+
+        REQUIRE(sprt.lowerBound() == Approx(-2.944).epsilon(0.001));
+        REQUIRE(sprt.upperBound() == Approx(2.944).epsilon(0.001));
+
+        REQUIRE(sprt.llr(0, 0, 0) == 0);
+        REQUIRE(sprt.status(10, 10, 10) == 0);
+        REQUIRE(sprt.llr(300, 400, 300) < 0);
+        REQUIRE(sprt.status(700, 200, 100) == 1);
+        REQUIRE(sprt.status(100, 200, 700) == -1);
+
+        // One-sided results still move the ratio, but not on a few games
+        REQUIRE(sprt.llr(10, 0, 0) > 0);
+        REQUIRE(sprt.llr(0, 0, 10) < 0);
+        REQUIRE(sprt.llr(0, 10, 0) < 0);
+        REQUIRE(sprt.status(3, 0, 0) == 0);
+        REQUIRE(sprt.status(500, 0, 0) == 1);
+        REQUIRE(sprt.status(0, 400, 0) == -1);
+
+        REQUIRE(Match::elo(50, 0, 50) == Approx(0).margin(1e-9));
+        REQUIRE(Match::elo(60, 20, 20) == Approx(-400 * std::log10(1 / 0.7 - 1)));
+        REQUIRE(Match::elo(20, 20, 60) == Approx(-Match::elo(60, 20, 20)));
+    }
+
+    SECTION("Play games")
+    {
+        auto options = Match::parseArgs({ "match", "--engine2", "FutilityMargin=120,RazorMargin=250",
+                                          "--nodes", "2000", "--threads", "2" });
+        REQUIRE(options.threads == 2);
+        REQUIRE(options.limits.nodes == 2000);
+        REQUIRE(options.engines[1].command.empty());
+        REQUIRE(options.engines[1].options.size() == 2);
+
+        Match::Player first(options.engines[0], options.limits, 1 << 20),
+                      second(options.engines[1], options.limits, 1 << 20);
+
+        // Mate in one, then checkmated
+        REQUIRE(Match::playGame(first, second, "7R/8/8/8/8/1K6/8/1k6 w - -", options) == 1);
+        REQUIRE(Match::playGame(first, second, "8/8/8/8/8/1k6/7r/1K6 b - -", options) == -1);
+
+        // Draws by stalemate and insufficient material
+        REQUIRE(Match::playGame(first, second, "R1R5/7R/1k6/7R/8/8/8/1K6 b - -", options) == 0);
+        REQUIRE(Match::playGame(first, second, "8/8/8/8/8/1K6/8/1k2N3 w - -", options) == 0);
+
+        // A won position is adjudicated by score long before mate
+        options.winScore = 500;
+        options.winPlies = 4;
+        REQUIRE(Match::playGame(first, second, "4k3/8/8/8/8/8/8/QQQ1K3 w - -", options) == 1);
+    }
+
+    SECTION("Positions in the tablebases are adjudicated")
+    {
+        std::string path = "matchtest";
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        REQUIRE(Tablebase::generate("KRK", path, 1));
+        REQUIRE(Tablebase::load(path) > 0);
+
+        auto options = Match::parseArgs({ "match", "--nodes", "1000", "--tablebases", path });
+        REQUIRE(options.tablebasePath == path);
+        Match::Player first(options.engines[0], options.limits, 1 << 20),
+                      second(options.engines[1], options.limits, 1 << 20);
+
+        int nMoves = 0;
+        auto onMove = [&](const Board&, Move, int) { nMoves++; };
+        REQUIRE(Match::playGame(first, second, "8/8/8/4k3/8/8/8/KR6 w - -", options, onMove) == 1);
+        REQUIRE(Match::playGame(first, second, "8/8/8/4k3/8/8/8/KR6 b - -", options, onMove) == 1);
+        REQUIRE(Match::playGame(first, second, "8/8/8/8/8/8/6k1/K6R b - -", options, onMove) == 0);
+        REQUIRE(nMoves == 0);
+
+        // Without the tables the games are played out
+        Tablebase::clear();
+        REQUIRE(Match::playGame(first, second, "8/8/8/8/8/8/6k1/K6R b - -", options, onMove) == 0);
+        REQUIRE(nMoves > 0);
+
+        std::filesystem::remove_all(path);
+    }
+
+    SECTION("Engines with bad options are reported before any game")
+    {
+        SearchLimits limits;
+        auto player = [&](const std::string& spec)
+        {
+            auto options = Match::parseArgs({ "match", "--engine1", spec });
+            return std::make_unique<Match::Player>(options.engines[0], limits, 1 << 20);
+        };
+
+        REQUIRE(player("FutilityMargin=120,MultiPV=2")->getError().empty());
+        REQUIRE(player("FutilityMargn=120")->getError() == "unknown option FutilityMargn");
+        REQUIRE(player("FutilityMargin=12x")->getError().find("invalid value 12x") == 0);
+        REQUIRE(player("FutilityMargin=5000")->getError().find("invalid value 5000") == 0);
+        REQUIRE(player("MultiPV=0")->getError().find("invalid value 0") == 0);
+
+        // An external engine is checked against the options it lists
+        std::string engine = "cmd=printf 'option name Hash type spin default 16 min 1 max 1024\\n"
+                             "option name Ponder type check default false\\nuciok\\nreadyok\\n'; cat >/dev/null";
+        REQUIRE(player(engine + ",Hash=64,Ponder=true")->getError().empty());
+        REQUIRE(player(engine + ",Hash=4096")->getError().find("invalid value 4096") == 0);
+        REQUIRE(player(engine + ",Threads=2")->getError() == "unknown option Threads");
+        REQUIRE(player("cmd=true")->getError().find("no uciok") != std::string::npos);
+    }
+}
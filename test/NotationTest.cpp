@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "globals.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "notation.hpp"
+
+TEST_CASE( "Move notation tests", "[notation]" )
+{
+    G::init();
+
+    SECTION("SAN moves")
+    {
+        // Knights on b3 and f3 and rooks on a1 and a5 reach the same squares
+        Board board("4k3/8/8/R7/8/1N3N2/8/R3K3 w Q -");
+
+        REQUIRE(Notation::toSAN(board, Move(B3, D2)) == "Nbd2");
+        REQUIRE(Notation::toSAN(board, Move(A1, A3)) == "R1a3");
+        REQUIRE(Notation::toSAN(board, Move(E1, C1, CASTLE)) == "O-O-O");
+        REQUIRE(Notation::toSAN(board, Move(A5, A8)) == "Ra8+");
+
+        REQUIRE(Notation::fromSAN(board, "Nbd2") == Move(B3, D2));
+        REQUIRE(Notation::fromSAN(board, "Nfd2") == Move(F3, D2));
+        REQUIRE(Notation::fromSAN(board, "R5a3") == Move(A5, A3));
+        REQUIRE(Notation::fromSAN(board, "O-O-O") == Move(E1, C1, CASTLE));
+        REQUIRE(Notation::fromSAN(board, "0-0-0") == Move(E1, C1, CASTLE));
+        REQUIRE(Notation::fromSAN(board, "Ra8+!") == Move(A5, A8));
+
+        // Ambiguous, illegal and malformed moves
+        REQUIRE(Notation::fromSAN(board, "Nd2").isNullMove());
+        REQUIRE(Notation::fromSAN(board, "O-O").isNullMove());
+        REQUIRE(Notation::fromSAN(board, "Kf8").isNullMove());
+        REQUIRE(Notation::fromSAN(board, "Nz9").isNullMove());
+        REQUIRE(Notation::fromSAN(board, "").isNullMove());
+
+        // Promotions and en passant
+        board = Board("1n2k3/P7/8/3pP3/8/8/8/4K3 w - d6");
+        REQUIRE(Notation::toSAN(board, Move(A7, B8, PROMOTION, QUEEN)) == "axb8=Q+");
+        REQUIRE(Notation::toSAN(board, Move(E5, D6, ENPASSANT)) == "exd6");
+        REQUIRE(Notation::fromSAN(board, "axb8=N") == Move(A7, B8, PROMOTION, KNIGHT));
+        REQUIRE(Notation::fromSAN(board, "axb8Q") == Move(A7, B8, PROMOTION, QUEEN));
+        REQUIRE(Notation::fromSAN(board, "exd6") == Move(E5, D6, ENPASSANT));
+        REQUIRE(Notation::fromSAN(board, "axb8").isNullMove());
+    }
+
+    SECTION("UCI moves")
+    {
+        Board board("1n2k3/P7/8/3pP3/8/8/8/4K3 w - d6");
+
+        REQUIRE(Notation::toUCI(Move(A7, B8, PROMOTION, ROOK)) == "a7b8r");
+        REQUIRE(Notation::fromUCI(board, "a7b8r") == Move(A7, B8, PROMOTION, ROOK));
+        REQUIRE(Notation::fromUCI(board, "e5d6") == Move(E5, D6, ENPASSANT));
+        REQUIRE(Notation::fromUCI(board, "e1e2") == Move(E1, E2));
+        REQUIRE(Notation::fromUCI(board, "a7b8").isNullMove());
+        REQUIRE(Notation::fromUCI(board, "e1e3").isNullMove());
+        REQUIRE(Notation::fromUCI(board, "e1").isNullMove());
+    }
+
+    SECTION("Round trip every legal move")
+    {
+        for (auto fen : { G::STARTFEN,
+                          std::string("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -"),
+                          std::string("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - -") })
+        {
+            Board board(fen);
+            auto gen = MoveGen::Generator(&board);
+            gen.run();
+
+            for (auto& move : gen.moves)
+            {
+                if (!board.isLegalMove(move))
+                    continue;
+
+                REQUIRE(Notation::fromSAN(board, Notation::toSAN(board, move)) == move);
+                REQUIRE(Notation::fromUCI(board, Notation::toUCI(move)) == move);
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+#include <fstream>
+#include <cstdio>
+#include <atomic>
+#include "globals.hpp"
+#include "pgn.hpp"
+
+static const std::string games =
+    "[Event \"Paris\"]\n"
+    "[White \"Morphy, Paul\"]\n"
+    "[Black \"Duke Karl / Count Isouard\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 d6 3. d4 Bg4 {This is a weak move\n"
+    "already.} 4. dxe5 Bxf3 5. Qxf3 dxe5 6. Bc4 Nf6 7. Qb3 Qe7 (7... Qd7 8. Qxb7 (8. Bxf7+)) 8.\n"
+    "Nc3 c6 9. Bg5 $4 b5?! 10. Nxb5 cxb5 11. Bxb5+ Nbd7 12. O-O-O Rd8 13. Rxd7 Rxd7 14.\n"
+    "Rd1 Qe6 15. Bxd7+ Nxd7 16. Qb8+ Nxb8 17. Rd8# 1-0\n"
+    "\n"
+    "[Event \"Promotion\"]\n"
+    "[FEN \"8/P7/8/8/8/8/8/k6K w - - 0 1\"]\n"
+    "[SetUp \"1\"]\n"
+    "[Result \"*\"]\n"
+    "\n"
+    "1.a8=Q+ Kb2 ; a comment to the end of the line\n"
+    "2.Qb7+ *\n"
+    "\n"
+    "[Event \"Castling\"]\n"
+    "[Result \"1/2-1/2\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 Nc6 3. Bc4 Bc5 4. 0-0 Nf6 5. Qe2 1/2-1/2\n"
+    "\n"
+    "[Event \"Illegal\"]\n"
+    "[Result \"0-1\"]\n"
+    "\n"
+    "1. e4 e5 2. Ke3 0-1\n";
+
+TEST_CASE( "PGN tests", "[pgn]" )
+{
+    G::init();
+
+    SECTION("Read games")
+    {
+        PGN::Reader reader(games);
+        PGN::Game game;
+
+        REQUIRE(reader.next(game));
+        REQUIRE(game.tags.size() == 4);
+        REQUIRE(game.tag("White") == "Morphy, Paul");
+        REQUIRE(game.tag("Black") == "Duke Karl / Count Isouard");
+        REQUIRE(game.tag("ECO") == "");
+        REQUIRE(game.result == "1-0");
+
+        std::vector<Move> moves;
+        REQUIRE(PGN::replay(game, [&](Board&, Move move) { moves.push_back(move); }));
+        REQUIRE(moves.size() == 33);
+        REQUIRE(moves.at(0) == Move(E2, E4));
+        REQUIRE(moves.at(22) == Move(E1, C1, CASTLE));
+        REQUIRE(moves.at(32) == Move(D1, D8));
+
+        REQUIRE(reader.next(game));
+        REQUIRE(game.tag("Event") == "Promotion");
+        REQUIRE(game.result == "*");
+
+        std::vector<std::string> fens;
+        REQUIRE(PGN::replay(game, [&](Board& board, Move) { fens.push_back(board.toFEN()); }));
+        REQUIRE(fens.size() == 3);
+        REQUIRE(fens.at(0) == "8/P7/8/8/8/8/8/k6K w - - 0 1");
+        REQUIRE(fens.at(2).substr(0, 8) == "Q7/8/8/8");
+
+        REQUIRE(reader.next(game));
+        REQUIRE(game.result == "1/2-1/2");
+        moves.clear();
+        REQUIRE(PGN::replay(game, [&](Board&, Move move) { moves.push_back(move); }));
+        REQUIRE(moves.size() == 9);
+        REQUIRE(moves.at(6) == Move(E1, G1, CASTLE));
+
+        REQUIRE(reader.next(game));
+        REQUIRE_FALSE(PGN::replay(game, [](Board&, Move) { }));
+
+        REQUIRE_FALSE(reader.next(game));
+    }
+
+    SECTION("Read a mapped file in parallel")
+    {
+        std::string filename = "pgntest.pgn";
+        {
+            std::ofstream ofs(filename);
+            for (int i = 0; i < 50; i++)
+                ofs << games << "\n";
+        }
+
+        {
+            MappedFile file(filename);
+            REQUIRE(file.isOpen());
+            REQUIRE(file.text().size() == 50 * (games.size() + 1));
+
+            auto parts = PGN::split(file.text(), 4);
+            REQUIRE(parts.size() == 4);
+            for (auto& part : parts)
+                REQUIRE(part.substr(0, 7) == "[Event ");
+
+            std::atomic<int> nGames(0),
+                             nMoves(0);
+            PGN::parallelForEach(file.text(), 4, [&](unsigned, const PGN::Game& game)
+            {
+                nGames++;
+                PGN::replay(game, [&](Board&, Move) { nMoves++; });
+            });
+
+            REQUIRE(nGames == 200);
+            REQUIRE(nMoves == 50 * (33 + 3 + 9 + 2));
+        }
+
+        std::remove(filename.c_str());
+        REQUIRE_FALSE(MappedFile(filename).isOpen());
+    }
+}
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include "globals.hpp"
+#include "board.hpp"
+#include "notation.hpp"
+#include "polyglot.hpp"
+#include "uci.hpp"
+
+static U64 keyAfter(const std::vector<std::string>& moves)
+{
+    Board board(G::STARTFEN);
+    for (auto& san : moves)
+        board.make(Notation::fromSAN(board, san));
+
+    return board.calculatePolyglotKey();
+}
+
+TEST_CASE( "Polyglot book tests", "[polyglot]" )
+{
+    G::init();
+
+    SECTION("Keys")
+    {
+        U64 start = Board(G::STARTFEN).calculatePolyglotKey();
+        REQUIRE(start == 0x463b96181691fc9c);
+        REQUIRE(start != Board("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq -").calculatePolyglotKey());
+        REQUIRE(start != Board("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Kkq -").calculatePolyglotKey());
+
+        // The reference keys of the book format
+        REQUIRE(keyAfter({ "e4" }) == 0x823c9b50fd114196);
+        REQUIRE(keyAfter({ "e4", "d5" }) == 0x0756b94461c50fb0);
+        REQUIRE(keyAfter({ "e4", "d5", "e5" }) == 0x662fafb965db29d4);
+        REQUIRE(keyAfter({ "e4", "d5", "e5", "f5" }) == 0x22a48b5a8e47ff78);
+        REQUIRE(keyAfter({ "e4", "d5", "e5", "f5", "Ke2" }) == 0x652a607ca3f242c1);
+        REQUIRE(keyAfter({ "e4", "d5", "e5", "f5", "Ke2", "Kf7" }) == 0x00fdd303c946bdd9);
+        REQUIRE(keyAfter({ "a4", "b5", "h4", "b4", "c4" }) == 0x3c8123ea7b067637);
+        REQUIRE(keyAfter({ "a4", "b5", "h4", "b4", "c4", "bxc3", "Ra3" }) == 0x5c3f9b829b279560);
+
+        // Transpositions share a key
+        REQUIRE(keyAfter({ "Nf3", "Nf6", "Nc3", "Nc6" }) == keyAfter({ "Nc3", "Nc6", "Nf3", "Nf6" }));
+
+        // The en passant file only counts when a capture is possible
+        REQUIRE(keyAfter({ "e4" }) == Board("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq -").calculatePolyglotKey());
+        REQUIRE(keyAfter({ "e4", "d5", "e5", "f5" })
+             != Board("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq -").calculatePolyglotKey());
+    }
+
+    SECTION("Moves")
+    {
+        Board board("r3k3/1P6/8/8/8/8/8/4K2R w Kq -");
+
+        REQUIRE(Polyglot::encodeMove(Move(E1, G1, CASTLE)) == Polyglot::encodeMove(Move(E1, H1)));
+        REQUIRE(Polyglot::decodeMove(board, Polyglot::encodeMove(Move(E1, H1))) == Move(E1, G1, CASTLE));
+        REQUIRE(Polyglot::decodeMove(board, Polyglot::encodeMove(Move(B7, A8, PROMOTION, QUEEN))) == Move(B7, A8, PROMOTION, QUEEN));
+        REQUIRE(Polyglot::decodeMove(board, Polyglot::encodeMove(Move(B7, B8, PROMOTION, KNIGHT))) == Move(B7, B8, PROMOTION, KNIGHT));
+        REQUIRE(Polyglot::decodeMove(board, Polyglot::encodeMove(Move(E1, E3))).isNullMove());
+    }
+
+    SECTION("Books")
+    {
+        Board board(G::STARTFEN);
+        U64 key = board.calculatePolyglotKey();
+        U16 e4 = Polyglot::encodeMove(Move(E2, E4)),
+            d4 = Polyglot::encodeMove(Move(D2, D4));
+
+        std::string filename = "polyglottest.bin";
+        {
+            std::ofstream ofs(filename, std::ios::binary);
+            Polyglot::writeEntry(ofs, { key - 1, e4, 1, 0 });
+            Polyglot::writeEntry(ofs, { key, e4, 3, 0 });
+            Polyglot::writeEntry(ofs, { key, d4, 1, 0 });
+            Polyglot::writeEntry(ofs, { key + 1, d4, 1, 0 });
+        }
+
+        Polyglot::Book book;
+        REQUIRE(book.open(filename));
+        REQUIRE(book.size() == 4);
+
+        auto entries = book.probe(key);
+        REQUIRE(entries.size() == 2);
+        REQUIRE(entries[0].move == e4);
+        REQUIRE(entries[0].weight == 3);
+        REQUIRE(entries[1].move == d4);
+        REQUIRE(book.probe(key + 2).empty());
+
+        int nE4 = 0;
+        for (int i = 0; i < 400; i++)
+        {
+            Move move = book.pick(board);
+            REQUIRE((move == Move(E2, E4) || move == Move(D2, D4)));
+            nE4 += move == Move(E2, E4);
+        }
+        REQUIRE(nE4 > 200);
+        REQUIRE(nE4 < 400);
+
+        board.make(Move(E2, E4));
+        REQUIRE(book.pick(board).isNullMove());
+
+        // The engine plays book moves without searching
+        std::ostringstream oss;
+        UCI::Controller controller(std::cin, oss);
+        REQUIRE(controller.execute("setoption name BookFile value " + filename));
+        REQUIRE(controller.execute("setoption name OwnBook value true"));
+        REQUIRE(controller.execute("position startpos"));
+        REQUIRE(controller.execute("go depth 10"));
+        REQUIRE(oss.str().find("info string book move\nbestmove ") != std::string::npos);
+
+        book.close();
+        std::remove(filename.c_str());
+        REQUIRE_FALSE(book.open(filename));
+    }
+}
@@ -1,7 +1,9 @@
 #include "catch.hpp"
+#include <sstream>
 #include "globals.hpp"
 #include "board.hpp"
 #include "search.hpp"
+#include "tt.hpp"
 
 enum ScoreType {
     NONESCORE,
@@ -106,3 +108,478 @@ TEST_CASE( "Integration search tests", "[search-integration]" )
 //     }
 
 // }
+
+TEST_CASE( "MultiPV search tests", "[search-multipv]" )
+{
+    G::init();
+
+    SECTION("Lines are distinct and ordered by score")
+    {
+        auto board = Board("k7/8/4r3/8/8/3Q4/4p3/K7 w - -");
+        SearchOptions options;
+        options.multiPV = 3;
+        Search search(&board, options);
+        search.think(4);
+
+        REQUIRE(search.pvLines.size() == 3);
+        REQUIRE(search.bestMove == Move(D3, D5));
+        REQUIRE(search.pvLines[0].move == search.bestMove);
+
+        for (unsigned i = 1; i < search.pvLines.size(); i++)
+        {
+            REQUIRE(search.pvLines[i-1].score >= search.pvLines[i].score);
+            for (unsigned j = 0; j < i; j++)
+                REQUIRE(!(search.pvLines[i].move == search.pvLines[j].move));
+        }
+    }
+
+    SECTION("Lines are limited by the number of legal moves")
+    {
+        auto board = Board("R1R5/7R/1k6/7R/8/P1P5/PKP5/1RP5 w - -");
+        SearchOptions options;
+        options.multiPV = 500;
+        Search search(&board, options);
+        search.think(1);
+
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+        unsigned nLegalMoves = 0;
+        for (auto& move : gen.moves)
+            if (board.isLegalMove(move))
+                nLegalMoves++;
+
+        REQUIRE(search.pvLines.size() == nLegalMoves);
+    }
+}
+
+TEST_CASE( "Limited search tests", "[search-limits]" )
+{
+    G::init();
+
+    SECTION("Node limited searches stop at the limit and are reproducible")
+    {
+        SearchLimits limits;
+        limits.nodes = 20000;
+
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        search.think(limits);
+
+        TT::table.clear();
+        auto board2 = Board(G::KIWIPETE);
+        Search search2(&board2);
+        search2.think(limits);
+
+        REQUIRE(search.getNodes() == limits.nodes);
+        REQUIRE(search2.getNodes() == limits.nodes);
+        REQUIRE(search.bestMove == search2.bestMove);
+        REQUIRE(search.bestScore == search2.bestScore);
+        REQUIRE(board.getKey() == board2.getKey());
+    }
+
+    SECTION("Interrupted iterations leave the last complete one's results")
+    {
+        for (int multiPV : { 1, 3 })
+        {
+            for (U64 nodes : { 3000ULL, 7000ULL, 20000ULL })
+            {
+                SearchLimits limits;
+                limits.nodes = nodes;
+
+                TT::table.clear();
+                auto board = Board(G::KIWIPETE);
+                Search search(&board);
+                search.setOutput(nullptr);
+                search.options.multiPV = multiPV;
+                search.think(limits);
+
+                REQUIRE(search.bestMove == search.pvLines[0].move);
+                REQUIRE(search.bestMove == search.pvLines[0].moves[0]);
+                REQUIRE(search.bestScore == search.pvLines[0].score);
+            }
+        }
+    }
+
+    SECTION("Mate searches find a mate in N")
+    {
+        SearchLimits limits;
+        limits.mate = 2;
+
+        auto board = Board("5rk1/pb2npp1/1pq4p/5p2/5B2/1B6/P2RQ1PP/2r1R2K b - -");
+        Search search(&board);
+        search.think(limits);
+
+        REQUIRE(search.bestScore == MATESCORE-3);
+        REQUIRE(search.bestMove == Move(C6, G2));
+    }
+}
+
+TEST_CASE( "Lazy eval search tests", "[search-lazy]" )
+{
+    G::init();
+
+    SECTION("The lazy eval is material and piece squares")
+    {
+        auto board = Board(G::STARTFEN);
+        REQUIRE(board.lazyEval() == Eval::TEMPO_BONUS);
+
+        board = Board("4k3/8/8/8/8/8/8/3QK3 b - -");
+        REQUIRE(board.lazyEval() < -QUEENSCORE / 2);
+    }
+
+    SECTION("Lazy evals do not change the search")
+    {
+        SearchLimits limits;
+        limits.depth = 7;
+
+        SearchOptions full;
+        full.lazyEvalMargin = MATESCORE;
+        full.lazyMobilityMargin = MATESCORE;
+
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        search.setOutput(nullptr);
+        search.think(limits);
+
+        TT::table.clear();
+        auto board2 = Board(G::KIWIPETE);
+        Search search2(&board2, full);
+        search2.setOutput(nullptr);
+        search2.think(limits);
+
+        REQUIRE(search.bestMove == search2.bestMove);
+        REQUIRE(search.bestScore == search2.bestScore);
+        REQUIRE(search.getNodes() == search2.getNodes());
+    }
+
+    SECTION("Debug mode checks the margins against the full eval")
+    {
+        SearchLimits limits;
+        limits.depth = 6;
+
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        std::ostringstream oss;
+        search.setOutput(&oss);
+        search.setDebug(true);
+        search.think(limits);
+
+        REQUIRE(oss.str().find("info string qsearch evals") != std::string::npos);
+        REQUIRE(oss.str().find(" errors 0 ") != std::string::npos);
+    }
+}
+
+TEST_CASE( "Eval cache search tests", "[search-evalcache]" )
+{
+    G::init();
+
+    SECTION("Evals are cached by key")
+    {
+        auto board = Board(G::KIWIPETE);
+        Eval::Cache cache;
+        int eval = 0;
+        REQUIRE(!cache.probe(board.getKey(), eval));
+
+        cache.save(board.getKey(), board.eval<false>());
+        REQUIRE(cache.probe(board.getKey(), eval));
+        REQUIRE(eval == board.eval<false>());
+
+        // A key sharing the slot replaces the entry
+        U64 other = board.getKey() ^ (U64)Eval::Cache::SIZE;
+        cache.save(other, 0);
+        REQUIRE(!cache.probe(board.getKey(), eval));
+    }
+
+    SECTION("The static eval is kept in the transposition table")
+    {
+        TT::Table table(1 << 16);
+        auto board = Board(G::KIWIPETE);
+        table.save(board.getKey(), 4, 25, TT_EXACT, Move(), -17);
+        REQUIRE(table.probe(board.getKey())->eval == -17);
+
+        table.save(board.getKey(), 5, 25, TT_EXACT, Move());
+        REQUIRE(table.probe(board.getKey())->eval == TT::NO_EVAL);
+    }
+
+    SECTION("The hit rate is reported")
+    {
+        SearchLimits limits;
+        limits.depth = 7;
+
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        std::ostringstream oss;
+        search.setOutput(&oss);
+        search.think(limits);
+
+        auto pos = oss.str().find("info string evalcache hits ");
+        REQUIRE(pos != std::string::npos);
+        REQUIRE(oss.str().find(" 0/") != pos + 26);
+    }
+}
+
+TEST_CASE( "Aspiration window search tests", "[search-aspiration]" )
+{
+    G::init();
+
+    SECTION("Shallow iterations search the full window")
+    {
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        search.setOutput(nullptr);
+        search.think(Search::ASPIRATION_DEPTH - 1);
+        REQUIRE(search.getResearches() == 0);
+    }
+
+    SECTION("A window far from the score is widened until it holds it")
+    {
+        for (int miss : { -500, 500 })
+        {
+            TT::table.clear();
+            auto board = Board(G::KIWIPETE);
+            Search search(&board);
+            search.setOutput(nullptr);
+            search.think(Search::ASPIRATION_DEPTH);
+            int score = search.bestScore;
+            U32 researches = search.getResearches();
+
+            // Each failed window is reported as a bound on the side it
+            // failed, then searched again
+            std::ostringstream oss;
+            search.setOutput(&oss);
+            int result = search.aspirationSearch(Search::ASPIRATION_DEPTH, score + miss);
+            REQUIRE(search.getResearches() > researches);
+            REQUIRE(oss.str().find(miss < 0 ? " lowerbound " : " upperbound ") != std::string::npos);
+            REQUIRE(oss.str().find(miss < 0 ? " upperbound " : " lowerbound ") == std::string::npos);
+
+            // The window grows by half each time, so a miss of 500 takes
+            // several searches, ending well outside the first window
+            REQUIRE(search.getResearches() - researches >= 3);
+            int window = Search::ASPIRATION_WINDOW;
+            REQUIRE(abs(result - (score + miss)) > window);
+            REQUIRE(abs(result - score) < 100);
+        }
+    }
+}
+
+TEST_CASE( "Late move reduction tests", "[search-lmr]" )
+{
+    G::init();
+
+    SECTION("Reductions follow the product of the logs")
+    {
+        // 0.75 + ln(depth) * ln(n) / 2.25, truncated
+        REQUIRE(Search::getReduction(1, 63) == 0);
+        REQUIRE(Search::getReduction(63, 1) == 0);
+        REQUIRE(Search::getReduction(2, 2) == 0);
+        REQUIRE(Search::getReduction(3, 4) == 1);
+        REQUIRE(Search::getReduction(8, 8) == 2);
+        REQUIRE(Search::getReduction(10, 10) == 3);
+        REQUIRE(Search::getReduction(20, 40) == 5);
+        REQUIRE(Search::getReduction(63, 63) == 8);
+    }
+
+    SECTION("Reductions grow with depth and move number")
+    {
+        for (int depth = 1; depth < Search::MAX_DEPTH; depth++)
+        {
+            for (int n = 1; n < Search::MAX_MOVES; n++)
+            {
+                if (depth > 1)
+                    REQUIRE(Search::getReduction(depth, n) >= Search::getReduction(depth - 1, n));
+                if (n > 1)
+                    REQUIRE(Search::getReduction(depth, n) >= Search::getReduction(depth, n - 1));
+            }
+        }
+    }
+}
+
+TEST_CASE( "History and countermove tests", "[search-history]" )
+{
+    G::init();
+
+    SECTION("Gravity keeps history entries within bounds")
+    {
+        int max = Search::HISTORY_MAX,
+            bonus = Search::HISTORY_MAX_BONUS;
+        I16 entry = 0;
+        I32 wide = 0;
+
+        // Repeated rewards approach the bound without passing it
+        for (int i = 0; i < 1000; i++)
+        {
+            Search::applyGravity(entry, bonus);
+            Search::applyGravity(wide, bonus);
+            REQUIRE(entry <= max);
+            REQUIRE(wide <= max);
+        }
+        REQUIRE(entry > max - bonus);
+
+        // And so do repeated penalties, from the other bound
+        for (int i = 0; i < 1000; i++)
+        {
+            Search::applyGravity(entry, -bonus);
+            REQUIRE(entry >= -max);
+        }
+        REQUIRE(entry < -max + bonus);
+
+        // Near a bound, a reward moves the entry less than a penalty
+        I16 high = I16(max - bonus);
+        I16 rewarded = high,
+            penalized = high;
+        Search::applyGravity(rewarded, bonus);
+        Search::applyGravity(penalized, -bonus);
+        REQUIRE(rewarded - high < high - penalized);
+    }
+
+    SECTION("Searches keep history within bounds and store countermoves")
+    {
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        search.setOutput(nullptr);
+        search.think(7);
+
+        int max = Search::HISTORY_MAX,
+            nonzero = 0,
+            nCounters = 0;
+        for (Color c : { WHITE, BLACK })
+        {
+            for (PieceType pt : { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING })
+            {
+                for (int sq = 0; sq < 64; sq++)
+                {
+                    int value = search.getHistory(c, pt, Square(sq));
+                    REQUIRE(abs(value) <= max);
+                    nonzero += value != 0;
+
+                    Move counter = search.getCounterMove(c, pt, Square(sq));
+                    nCounters += !counter.isNullMove();
+                    if (!counter.isNullMove())
+                        REQUIRE(!(counter.from() == counter.to()));
+                }
+            }
+        }
+        REQUIRE(nonzero > 0);
+        REQUIRE(nCounters > 0);
+
+        // Both are cleared for the next search
+        search.reset();
+        for (int sq = 0; sq < 64; sq++)
+        {
+            REQUIRE(search.getHistory(WHITE, KNIGHT, Square(sq)) == 0);
+            REQUIRE(search.getCounterMove(BLACK, PAWN, Square(sq)).isNullMove());
+        }
+    }
+}
+
+TEST_CASE( "PV collection tests", "[search-pv]" )
+{
+    G::init();
+
+    SECTION("A truncated line is completed from the TT")
+    {
+        TT::Table table(1 << 16);
+        auto board = Board(G::STARTFEN);
+        U64 key = board.getKey();
+        Search search(&board, SearchOptions(), &table);
+        search.reset();
+
+        // No line was collected, so it is all followed from the TT
+        std::vector<Move> moves = { Move(E2, E4), Move(E7, E5), Move(G1, F3) };
+        for (auto& move : moves)
+        {
+            table.save(board.getKey(), 1, 0, TT_EXACT, move);
+            board.make(move);
+        }
+        table.save(board.getKey(), 1, 0, TT_EXACT, Move(A1, A8));
+        for (size_t i = 0; i < moves.size(); i++)
+            board.unmake();
+
+        // The line stops at an illegal move, and at the depth
+        Move line[Search::MAX_DEPTH];
+        REQUIRE(search.getPV(line, 5) == 3);
+        for (size_t i = 0; i < moves.size(); i++)
+            REQUIRE(line[i] == moves[i]);
+        REQUIRE(search.getPV(line, 2) == 2);
+        REQUIRE(board.getKey() == key);
+    }
+
+    SECTION("Lines cut short by hash hits reach the search depth")
+    {
+        // The second search finds exact entries at every PV node
+        TT::table.clear();
+        for (int i = 0; i < 2; i++)
+        {
+            auto board = Board(G::KIWIPETE);
+            Search search(&board);
+            search.setOutput(nullptr);
+            search.think(6);
+
+            auto& pvLine = search.pvLines[0];
+            REQUIRE(pvLine.length == 6);
+            REQUIRE(pvLine.moves[0] == search.bestMove);
+            for (int j = 0; j < pvLine.length; j++)
+            {
+                REQUIRE(board.isLegalMove(pvLine.moves[j]));
+                board.make(pvLine.moves[j]);
+            }
+        }
+    }
+}
+
+TEST_CASE( "Root move ordering tests", "[search-rootmoves]" )
+{
+    G::init();
+
+    SECTION("Root moves are ordered by score, then the previous score, then nodes")
+    {
+        RootMove a(Move(E2, E4)), b(Move(D2, D4));
+
+        a.score = 10; b.score = 5;
+        REQUIRE(a < b);
+        REQUIRE(!(b < a));
+
+        // Moves that failed low share a score, and are ordered by the
+        // previous iteration's score
+        a.score = b.score = -MATESCORE;
+        a.prevScore = -20; b.prevScore = 30;
+        REQUIRE(b < a);
+
+        // And then by the size of their subtrees
+        a.prevScore = b.prevScore = -MATESCORE;
+        a.nodes = 500; b.nodes = 100;
+        REQUIRE(a < b);
+        REQUIRE(!(a < a));
+    }
+
+    SECTION("A search leaves the root moves in that order")
+    {
+        TT::table.clear();
+        auto board = Board(G::KIWIPETE);
+        Search search(&board);
+        search.setOutput(nullptr);
+        search.think(6);
+
+        auto& rootMoves = search.rootMoves;
+        REQUIRE(rootMoves.size() == 48);
+        REQUIRE(std::is_sorted(rootMoves.begin(), rootMoves.end()));
+        REQUIRE(rootMoves[0].move == search.bestMove);
+        REQUIRE(rootMoves[0].score == search.bestScore);
+
+        // Every move was searched, and the earlier iteration scored the best
+        U64 nodes = 0;
+        for (auto& rootMove : rootMoves)
+        {
+            REQUIRE(rootMove.nodes > 0);
+            nodes += rootMove.nodes;
+        }
+        REQUIRE(nodes <= search.getNodes());
+        REQUIRE(rootMoves[0].prevScore > -MATESCORE);
+    }
+}
@@ -0,0 +1,208 @@
+#include "catch.hpp"
+#include <set>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include "globals.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+#include "tablebase.hpp"
+#include "syzygy.hpp"
+
+static void put16(std::vector<U8>& out, U64 x)
+{
+    out.push_back(U8(x & 0xFF));
+    out.push_back(U8(x >> 8));
+}
+
+static void put32(std::vector<U8>& out, U64 x)
+{
+    put16(out, x & 0xFFFF);
+    put16(out, x >> 16);
+}
+
+static void write(const std::string& filename, const std::vector<U8>& bytes)
+{
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+}
+
+// A KQvK win/draw/loss table where white to move wins but at the given
+// indices, coded one bit per position in blocks of 400, and black to move
+// loses everywhere
+static std::vector<U8> kqkWDL(const std::set<U64>& draws)
+{
+    const U64 SIZE = 31332, PER_BLOCK = 400, SPAN = 1024,
+              BLOCKS = (SIZE + PER_BLOCK - 1) / PER_BLOCK;
+
+    std::vector<U8> out = { 0x71, 0xE8, 0x23, 0x5D,
+                            1,                  // Split by side to move
+                            0,                  // Group order
+                            0x66, 0x55, 0xEE,   // K, Q and k for both sides
+                            0 };
+
+    // Symbols 0 and 1 of one bit, leaves for a draw and a win
+    out.insert(out.end(), { 0, 6, 10, 0 });
+    put32(out, BLOCKS);
+    out.insert(out.end(), { 1, 1 });
+    put16(out, 0);
+    put16(out, 2);
+    out.insert(out.end(), { 2, 0xF0, 0xFF, 4, 0xF0, 0xFF });
+
+    // A single value for black
+    out.insert(out.end(), { 0x80, 0 });
+
+    for (U64 k = 0; k < (SIZE + SPAN - 1) / SPAN; k++)
+    {
+        U64 i = k * SPAN + SPAN / 2,
+            block = std::min(i / PER_BLOCK, BLOCKS - 1);
+        put32(out, block);
+        put16(out, i - block * PER_BLOCK);
+    }
+    for (U64 block = 0; block < BLOCKS; block++)
+        put16(out, std::min(PER_BLOCK, SIZE - block * PER_BLOCK) - 1);
+
+    out.resize((out.size() + 63) / 64 * 64);
+    size_t data = out.size();
+    out.resize(data + 64 * BLOCKS);
+    for (U64 i = 0; i < SIZE; i++)
+        if (!draws.count(i))
+            out[data + 64 * (i / PER_BLOCK) + (i % PER_BLOCK) / 8] |= U8(0x80 >> (i % PER_BLOCK) % 8);
+
+    return out;
+}
+
+// A KQvK distance to zeroing table for white to move, of 5 moves everywhere
+static std::vector<U8> kqkDTZ()
+{
+    return { 0xD7, 0x66, 0x0C, 0xA5, 1, 0, 0x06, 0x05, 0x0E, 0, 0x80, 5 };
+}
+
+static Syzygy::WDL probeWDL(const std::string& fen)
+{
+    Board board(fen);
+    Syzygy::WDL wdl;
+    REQUIRE(Syzygy::probeWDL(board, wdl));
+    REQUIRE(board.getKey() == Board(fen).getKey());
+    return wdl;
+}
+
+TEST_CASE( "Syzygy tests", "[syzygy]" )
+{
+    G::init();
+
+    std::string path = "syzygytest";
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+
+    // Wins but where the white king on b1, the queen on d3 and the black
+    // king on h8 give the index (0 * 63 + 18) * 62 + 61
+    write(path + "/KQvK.rtbw", kqkWDL({ 1177 }));
+    write(path + "/KQvK.rtbz", kqkDTZ());
+    write(path + "/KQvK.txt", kqkWDL({}));
+    write(path + "/KRvK.rtbw", std::vector<U8>(64, 0x5D));
+
+    SECTION("Tables are found by name and checked")
+    {
+        REQUIRE(Syzygy::load(path) == 1);
+        REQUIRE(Syzygy::largest() == 3);
+        REQUIRE(Syzygy::load("nowhere:" + path) == 1);
+
+        Syzygy::clear();
+        REQUIRE(Syzygy::largest() == 0);
+        REQUIRE(Syzygy::load("nowhere") == 0);
+
+        Board board("7k/8/8/8/8/4Q3/8/1K6 w - -");
+        Syzygy::WDL wdl;
+        REQUIRE(!Syzygy::probeWDL(board, wdl));
+    }
+
+    SECTION("Win/draw/loss probes")
+    {
+        REQUIRE(Syzygy::load(path) == 1);
+
+        REQUIRE(probeWDL("7k/8/8/8/8/3Q4/8/1K6 w - -") == Syzygy::DRAW);
+        REQUIRE(probeWDL("7k/8/8/8/8/4Q3/8/1K6 w - -") == Syzygy::WIN);
+        REQUIRE(probeWDL("7k/8/8/8/8/4Q3/8/1K6 b - -") == Syzygy::LOSS);
+
+        // The same positions mirrored, with the colors reversed
+        REQUIRE(probeWDL("k7/8/8/8/8/4Q3/8/6K1 w - -") == Syzygy::DRAW);
+        REQUIRE(probeWDL("1k6/8/3q4/8/8/8/8/7K b - -") == Syzygy::DRAW);
+        REQUIRE(probeWDL("1k6/8/4q3/8/8/8/8/7K b - -") == Syzygy::WIN);
+
+        // Captures are searched, down to the bare kings
+        REQUIRE(probeWDL("8/8/8/8/8/8/6Qk/K7 b - -") == Syzygy::DRAW);
+
+        // Material without a table
+        Board board("8/8/8/4k3/8/8/8/KR6 w - -");
+        Syzygy::WDL wdl;
+        REQUIRE(!Syzygy::probeWDL(board, wdl));
+    }
+
+    SECTION("Distance to zeroing probes")
+    {
+        REQUIRE(Syzygy::load(path) == 1);
+
+        // Moves are counted in plies, and the other side to move is found
+        // by searching its moves
+        int dtz;
+        Board board("7k/8/8/8/8/4Q3/8/1K6 w - -");
+        REQUIRE(Syzygy::probeDTZ(board, dtz));
+        REQUIRE(dtz == 11);
+        board = Board("7k/8/8/8/8/4Q3/8/1K6 b - -");
+        REQUIRE(Syzygy::probeDTZ(board, dtz));
+        REQUIRE(dtz == -12);
+        board = Board("7k/8/8/8/8/3Q4/8/1K6 w - -");
+        REQUIRE(Syzygy::probeDTZ(board, dtz));
+        REQUIRE(dtz == 0);
+    }
+
+    SECTION("Root moves keep the tablebase result")
+    {
+        REQUIRE(Syzygy::load(path) == 1);
+
+        auto board = Board("8/8/2k5/8/3Q4/8/8/7K w - -");
+        auto gen = MoveGen::Generator(&board);
+        gen.run();
+        std::vector<Move> moves;
+        for (auto& move : gen.moves)
+            if (board.isLegalMove(move))
+                moves.push_back(move);
+
+        // The queen is not left next to the king
+        std::vector<int> ranks;
+        REQUIRE(Syzygy::rankRootMoves(board, moves, ranks));
+        int best = *std::max_element(ranks.begin(), ranks.end()),
+            kept = 0;
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            if (ranks[i] == best)
+            {
+                REQUIRE(G::DISTANCE[moves[i].to()][C6] > 1);
+                kept++;
+            }
+        }
+        REQUIRE(kept == 25);
+    }
+
+    SECTION("The search does not use the tables")
+    {
+        REQUIRE(Syzygy::load(path) == 1);
+
+        std::ostringstream oss;
+        SearchLimits limits;
+        limits.depth = 3;
+        TT::table.clear();
+        auto board = Board("8/8/2k5/8/3Q4/8/8/7K w - -");
+        Search search(&board);
+        search.setOutput(&oss);
+        search.think(limits);
+        REQUIRE(search.rootMoves.size() == 30);
+        REQUIRE(oss.str().find(" tbhits ") == std::string::npos);
+    }
+
+    Syzygy::clear();
+    std::filesystem::remove_all(path);
+}
@@ -0,0 +1,225 @@
+#include "catch.hpp"
+#include <sstream>
+#include <filesystem>
+#include "globals.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "endgame.hpp"
+#include "tablebase.hpp"
+#include "movegen.hpp"
+
+static int probe(const std::string& fen, int ply = 0)
+{
+    int score = 0;
+    REQUIRE(Tablebase::probe(Board(fen), score, ply));
+    return score;
+}
+
+// The position with the pieces on their squares
+static Board place(const std::vector<std::pair<char, int>>& pieces, Color stm)
+{
+    std::string fen(64, '1');
+    for (auto& piece : pieces)
+        fen[(size_t)((7 - piece.second / 8) * 8 + piece.second % 8)] = piece.first;
+    for (size_t rank = 7; rank > 0; rank--)
+        fen.insert(rank * 8, "/");
+    return Board(fen + (stm == WHITE ? " w - -" : " b - -"));
+}
+
+// The best score from the tables after each legal move, searching the
+// replies to double pushes, and counting the positions where taking en
+// passant is the only best reply
+static int searchTables(Board& board, int ply, int& enPassantBest)
+{
+    auto gen = MoveGen::Generator(&board);
+    gen.run();
+
+    int best = -MATESCORE - 1,
+        bestOther = -MATESCORE - 1;
+    for (auto& move : gen.moves)
+    {
+        if (!board.isLegalMove(move))
+            continue;
+
+        board.make(move);
+        int score;
+        if (board.getEnPassant() != INVALID)
+            score = -searchTables(board, ply + 1, enPassantBest);
+        else
+        {
+            REQUIRE(Tablebase::probe(board, score, ply + 1));
+            score = -score;
+        }
+        board.unmake();
+
+        best = std::max(best, score);
+        if (move.type() != ENPASSANT)
+            bestOther = std::max(bestOther, score);
+    }
+
+    if (best == -MATESCORE - 1)
+        return board.isCheck() ? -MATESCORE + ply : DRAWSCORE;
+
+    enPassantBest += best > bestOther;
+    return best;
+}
+
+TEST_CASE( "Tablebase tests", "[tablebase]" )
+{
+    G::init();
+
+    std::string path = "tablebasetest";
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+
+    SECTION("Material codes")
+    {
+        REQUIRE(Tablebase::normalize("KKQ") == "KQK");
+        REQUIRE(Tablebase::normalize("KNKB") == "KBKN");
+        REQUIRE(Tablebase::normalize("KPRK") == "KRPK");
+        REQUIRE(Tablebase::normalize("KRKR") == "KRKR");
+
+        auto codes = Tablebase::combinations(3);
+        REQUIRE(codes == VecStr({ "KK", "KBK", "KNK", "KPK", "KQK", "KRK" }));
+        REQUIRE(Tablebase::combinations(4).size() == 6 + 15 + 15);
+    }
+
+    SECTION("Tables are generated with the tables they convert to")
+    {
+        REQUIRE(!Tablebase::generate("KQ", path, 2));
+        REQUIRE(!Tablebase::generate("KQKRRRR", path, 2));
+
+        Tablebase::clear();
+        REQUIRE(Tablebase::generate("KPK", path, 2));
+        REQUIRE(Tablebase::load(path) == 6);
+        REQUIRE(Tablebase::largest() == 3);
+
+        // Mates, from both sides and with the colors reversed
+        REQUIRE(probe("k7/8/1K6/8/8/8/8/6Q1 w - -") == MATESCORE - 1);
+        REQUIRE(probe("k7/8/1K6/8/8/8/8/6Q1 w - -", 5) == MATESCORE - 6);
+        REQUIRE(probe("k7/1Q6/1K6/8/8/8/8/8 b - -") == -MATESCORE);
+        REQUIRE(probe("8/8/8/8/8/1k6/1q6/K7 w - -") == -MATESCORE);
+        REQUIRE(probe("8/8/8/8/8/8/8/K6k w - -") == DRAWSCORE);
+        REQUIRE(probe("8/8/8/8/8/8/8/KB5k b - -") == DRAWSCORE);
+
+        // The longest mates are 10 moves with a queen and 16 with a rook
+        REQUIRE(probe("8/8/8/8/3k4/8/8/K6Q w - -") >= MATESCORE - 19);
+        REQUIRE(probe("8/8/8/8/3k4/8/8/K6R w - -") >= MATESCORE - 31);
+        REQUIRE(probe("8/8/8/8/3k4/8/8/K6R w - -") < MATESCORE - 10);
+
+        // Castling rights and en passant squares are not in the tables
+        int score;
+        REQUIRE(!Tablebase::probe(Board(G::STARTFEN), score));
+        REQUIRE(!Tablebase::probe(Board("4k3/8/8/8/8/8/8/R3K3 w Q -"), score));
+        REQUIRE(!Tablebase::probe(Board("8/8/8/4k3/8/8/8/KR5R w - -"), score));
+    }
+
+    SECTION("KPK agrees with the bitbase")
+    {
+        Tablebase::clear();
+        REQUIRE(Tablebase::generate("KPK", path, 2));
+
+        int positions = 0;
+        for (int wk = 0; wk < 64; wk++)
+        {
+            for (int bk = 0; bk < 64; bk++)
+            {
+                for (int pawn = A2; pawn <= H7; pawn += 3)
+                {
+                    if (wk == bk || wk == pawn || bk == pawn || G::DISTANCE[wk][bk] <= 1)
+                        continue;
+
+                    for (Color stm : { WHITE, BLACK })
+                    {
+                        std::string fen(64, '1');
+                        fen[(size_t)((7 - wk / 8) * 8 + wk % 8)] = 'K';
+                        fen[(size_t)((7 - bk / 8) * 8 + bk % 8)] = 'k';
+                        fen[(size_t)((7 - pawn / 8) * 8 + pawn % 8)] = 'P';
+                        for (size_t rank = 7; rank > 0; rank--)
+                            fen.insert(rank * 8, "/");
+                        Board board(fen + (stm == WHITE ? " w - -" : " b - -"));
+
+                        // Black cannot be in check with white to move
+                        if (stm == WHITE && board.calculateCheckingPieces(BLACK))
+                            continue;
+
+                        int score;
+                        REQUIRE(Tablebase::probe(board, score));
+                        bool wins = stm == WHITE ? score > 0 : score < 0;
+                        REQUIRE(wins == Endgame::probeKPK(WHITE, Square(wk), Square(pawn), Square(bk), stm));
+                        positions++;
+                    }
+                }
+            }
+        }
+        REQUIRE(positions > 10000);
+    }
+
+    SECTION("Double pushes can be taken en passant")
+    {
+        Tablebase::clear();
+        REQUIRE(Tablebase::generate("KPKP", path, 2));
+
+        // A pawn on its second rank next to one that can take it en passant,
+        // from both sides
+        int positions = 0,
+            enPassantBest = 0;
+        for (Color stm : { WHITE, BLACK })
+        {
+            for (int file = 0; file < 8; file++)
+            {
+                for (int side : { -1, 1 })
+                {
+                    if (file + side < 0 || file + side > 7)
+                        continue;
+
+                    int pusher = stm == WHITE ? A2 + file : A7 + file,
+                        taker = (stm == WHITE ? A4 : A5) + file + side;
+                    for (int wk = 0; wk < 64; wk++)
+                    {
+                        for (int bk = 0; bk < 64; bk++)
+                        {
+                            if (wk == bk || G::DISTANCE[wk][bk] <= 1 || wk == pusher || wk == taker
+                                || bk == pusher || bk == taker)
+                                continue;
+
+                            Board board = place({ { 'K', wk }, { 'k', bk },
+                                                  { stm == WHITE ? 'P' : 'p', pusher },
+                                                  { stm == WHITE ? 'p' : 'P', taker } }, stm);
+                            if (board.calculateCheckingPieces(~stm))
+                                continue;
+
+                            int score;
+                            REQUIRE(Tablebase::probe(board, score));
+                            REQUIRE(score == searchTables(board, 0, enPassantBest));
+                            positions++;
+                        }
+                    }
+                }
+            }
+        }
+        REQUIRE(positions > 50000);
+        REQUIRE(enPassantBest > 0);
+    }
+
+    SECTION("Search scores tablebase positions by their distance to mate")
+    {
+        Tablebase::clear();
+        REQUIRE(Tablebase::generate("KRK", path, 1));
+
+        std::ostringstream oss;
+        auto board = Board("8/8/8/8/3k4/8/8/K5R1 w - -");
+        TT::table.clear();
+        Search search(&board);
+        search.setOutput(&oss);
+        search.think(4);
+
+        int expected;
+        REQUIRE(Tablebase::probe(Board("8/8/8/8/3k4/8/8/K5R1 w - -"), expected));
+        REQUIRE(search.bestScore == expected);
+        REQUIRE(oss.str().find(" tbhits ") != std::string::npos);
+    }
+
+    Tablebase::clear();
+    std::filesystem::remove_all(path);
+}
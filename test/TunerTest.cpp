@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include "globals.hpp"
+#include "board.hpp"
+#include "eval.hpp"
+#include "epd.hpp"
+#include "tuner.hpp"
+
+TEST_CASE( "Tuner tests", "[tuner]" )
+{
+    G::init();
+
+    SECTION("The parameter vector holds the eval parameters")
+    {
+        auto params = Tuner::defaults();
+        REQUIRE(params.size() == Tuner::NPARAMS);
+        REQUIRE(params[Tuner::PASSED_PAWN + ENDGAME] == Eval::PassedPawnBonus[ENDGAME]);
+        REQUIRE(params[Tuner::TEMPO] == Eval::TEMPO_BONUS);
+        REQUIRE(params[Tuner::PIECE_VALUE + QUEEN-1] == QUEENSCORE);
+        REQUIRE(params[Tuner::QUEEN_TROPISM + 1] == Eval::QUEEN_TROPISM[1]);
+        REQUIRE(params[Tuner::PIECE_SQUARE + 128*(KING-1) + 64*ENDGAME + 27] == Eval::PieceSqValues[KING-1][ENDGAME][27]);
+    }
+
+    SECTION("The features reproduce the eval")
+    {
+        auto params = Tuner::defaults();
+        auto positions = EPD::load("test/arasan20.epd");
+        positions.push_back({ G::STARTFEN, "", {}, {} });
+        positions.push_back({ "8/8/4k3/3p4/3P4/4K3/8/8 w - -", "", {}, {} });
+        positions.push_back({ "r3k2r/pp3ppp/2n5/3q4/3P4/2N5/PP3PPP/R2QK2R b KQkq -", "", {}, {} });
+        positions.push_back({ "8/4kp2/2b5/8/8/2B5/4KPP1/8 w - -", "", {}, {} });
+        REQUIRE(positions.size() > 3);
+
+        std::vector<Tuner::Feature> features;
+        for (auto& position : positions)
+        {
+            Board board(position.fen);
+            features.clear();
+            Tuner::extract(board, features);
+
+            double phase = (double)board.calculatePhase() / TOTALPHASE;
+            double score = Tuner::evaluate(params, features.data(), features.data() + features.size(), phase);
+            int color = board.sideToMove() == WHITE ? 1 : -1;
+
+            // The eval rounds some tapered terms to whole centipawns
+            INFO(position.fen);
+            REQUIRE(std::abs(score - color * board.eval<false>()) < 8);
+        }
+    }
+
+    SECTION("Tuning lowers the loss, and writes a header")
+    {
+        std::string epdFile = "tunertest.epd";
+        {
+            std::ofstream ofs(epdFile);
+            for (int i = 0; i < 50; i++)
+                ofs << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - c9 \"1/2-1/2\";\n"
+                    << "4k3/8/8/8/8/8/3PPP2/4K3 w - - c9 \"1-0\";\n"
+                    << "4k3/pp6/8/8/8/8/8/3QK3 b - - c9 \"1-0\";\n"
+                    << "3qk3/8/8/8/8/8/PPP5/4K3 w - - c9 \"0-1\";\n"
+                    << "4k3/8/8/8/3q4/8/8/3QK3 w - - c9 \"1/2-1/2\";\n"
+                    << "4k3/8/8/8/8/8/8/4K3 w - - bm Ke2;\n";
+        }
+
+        auto options = Tuner::parseArgs({ "tune", "--input", epdFile, "--threads", "2",
+                                          "--epochs", "50", "--rate", "2" });
+        REQUIRE(options.threads == 2);
+        REQUIRE(options.epochs == 50);
+
+        Tuner::Stats stats;
+        auto shards = Tuner::load(epdFile, options.threads, stats);
+        REQUIRE(shards.size() == 2);
+
+        // The line with no result is skipped, and the queen en prise is not quiet
+        REQUIRE(stats.lines == 250);
+        REQUIRE(stats.positions == 200);
+
+        auto params = Tuner::defaults();
+        std::ostringstream log;
+        stats = Tuner::tune(options, params, log);
+        REQUIRE(stats.K > 0);
+        REQUIRE(stats.loss < stats.startLoss);
+
+        std::ostringstream header;
+        Tuner::write(header, params);
+        REQUIRE(header.str().find("const int PieceSqValues[6][2][64]") != std::string::npos);
+        REQUIRE(header.str().find("#endif") != std::string::npos);
+
+        std::remove(epdFile.c_str());
+    }
+
+    SECTION("The default parameters are written as the current header")
+    {
+        std::ifstream ifs("include/evalparams.hpp");
+        std::stringstream current;
+        current << ifs.rdbuf();
+
+        std::ostringstream header;
+        Tuner::write(header, Tuner::defaults());
+        REQUIRE(header.str() == current.str());
+    }
+}
@@ -1,4 +1,5 @@
 #include "catch.hpp"
+#include <sstream>
 #include "globals.hpp"
 #include "uci.hpp"
 
@@ -10,6 +11,7 @@ TEST_CASE( "Test UCI", "[uci]")
     SECTION("uci")
     {
         REQUIRE(controller.execute("uci"));
+        REQUIRE(controller.execute("ucinewgame"));
     }
 
     SECTION("debug")
@@ -18,6 +20,30 @@ TEST_CASE( "Test UCI", "[uci]")
         REQUIRE(controller.execute("debug off"));
     }
 
+    SECTION("setoption")
+    {
+        REQUIRE(controller.execute("setoption name FutilityMargin value 120"));
+        REQUIRE(controller.options().futilityMargin == 120);
+        REQUIRE(controller.execute("go depth 3"));
+
+        // Values are clamped to the advertised range
+        REQUIRE(controller.execute("setoption name RazorMargin value 5000"));
+        REQUIRE(controller.options().razorMargin == SearchOptions::MAX_MARGIN);
+        REQUIRE(controller.execute("setoption name MultiPV value 0"));
+        REQUIRE(controller.options().multiPV == 1);
+
+        // Invalid values are rejected and leave the option unchanged
+        std::ostringstream oss;
+        UCI::Controller quiet(std::cin, oss);
+        int razorMargin = quiet.options().razorMargin;
+        for (auto value : { "abc", "12abc", "99999999999", "" })
+        {
+            REQUIRE(quiet.execute(std::string("setoption name RazorMargin value ") + value));
+            REQUIRE(quiet.options().razorMargin == razorMargin);
+        }
+        REQUIRE(oss.str().find("info string invalid value abc for option RazorMargin") != std::string::npos);
+    }
+
     SECTION("position")
     {
         REQUIRE(controller.execute("position fen rnbqkbnr/pp2pppp/3p4/1Bp5/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq -"));
@@ -28,6 +54,16 @@ TEST_CASE( "Test UCI", "[uci]")
     {
         REQUIRE(controller.execute("go perft 4"));
         REQUIRE(controller.execute("go depth 4"));
+        REQUIRE(controller.execute("go nodes 5000"));
+        REQUIRE(controller.execute("go mate 1"));
+
+        // Clock limits end the search, and an infinite one has a default time
+        std::ostringstream oss;
+        UCI::Controller timed(std::cin, oss);
+        REQUIRE(timed.execute("go wtime 300 btime 300 winc 0 binc 0"));
+        REQUIRE(oss.str().find("bestmove ") != std::string::npos);
+        REQUIRE(timed.execute("go infinite movetime 50"));
+        REQUIRE(timed.execute("go movestogo 1 wtime 100 btime 100"));
     }
 
     SECTION("move")
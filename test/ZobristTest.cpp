@@ -18,6 +18,7 @@ void recursiveZobristCheck(Board board, int depth)
 
         board.make(move);
         REQUIRE(board.calculateKey() == board.getKey());
+        REQUIRE(board.calculateMaterialKey() == board.getMaterialKey());
         recursiveZobristCheck(board, depth-1);
         board.unmake();
     }
@@ -33,6 +34,18 @@ TEST_CASE( "Zobrist hashing", "[zobrist]" )
         REQUIRE(board.calculateKey() == board.getKey());
         board = Board(G::KIWIPETE);
         REQUIRE(board.calculateKey() == board.getKey());
+        REQUIRE(board.calculateMaterialKey() == board.getMaterialKey());
+    }
+
+    SECTION("Material keys depend on the piece counts only")
+    {
+        REQUIRE(Board("8/8/8/4k3/8/8/8/K6R w - -").getMaterialKey()
+             == Board("7R/8/8/8/2k5/8/1K6/8 b - -").getMaterialKey());
+        REQUIRE(Board("8/8/8/4k3/8/8/8/K6R w - -").getMaterialKey()
+             != Board("8/8/8/4k3/8/8/8/K6r w - -").getMaterialKey());
+        REQUIRE(Board(G::STARTFEN).getMaterialKey() == Board(G::KIWIPETE).getMaterialKey());
+        REQUIRE(Board("8/8/8/4k3/8/8/8/K6R w - -").getMaterialKey()
+             != Board("8/8/8/4k3/8/8/8/K6Q w - -").getMaterialKey());
     }
 
     SECTION("Check hash validity after making moves")